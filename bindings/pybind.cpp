@@ -1,7 +1,11 @@
 #include "NihonKohdenData.h"
+#include "BatchConverter.h"
+#include "Anonymizer.h"
 #include "MFERData.h"
+#include "SummaryPyramid.h"
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <pybind11/numpy.h>
 #include <pybind11/iostream.h>
 
 namespace py = pybind11;
@@ -12,10 +16,16 @@ void printFileHeader(const std::string &filename)
     data.printHeader();
 }
 
-void convertFileToCsv(const std::string &filename, const std::string &outputFilename)
+void convertFileToCsv(const std::string &filename, const std::string &outputFilename, int precision, unsigned int threads)
 {
     NihonKohdenData data(filename);
-    data.writeToCsv(outputFilename);
+    data.writeToCsv(outputFilename, precision, threads);
+}
+
+std::vector<ConversionResult> convertFiles(const std::vector<std::string> &inputs, const std::string &outputDirectory, const std::string &format,
+                                           unsigned int threads, uint64_t memoryLimit)
+{
+    return convertMany(inputs, outputDirectory, getOutputFormat(format), threads, memoryLimit);
 }
 
 Header getHeader(const std::string &filename)
@@ -24,6 +34,53 @@ Header getHeader(const std::string &filename)
     return data.getHeader();
 }
 
+// NumPy type of the samples of a data type
+py::dtype sampleDtype(DataType dataType)
+{
+    switch (dataType)
+    {
+    case DataType::INT_16_S:
+        return py::dtype::of<int16_t>();
+    case DataType::INT_16_U:
+    case DataType::STATUS_16:
+        return py::dtype::of<uint16_t>();
+    case DataType::INT_32_S:
+        return py::dtype::of<int32_t>();
+    case DataType::INT_8_S:
+        return py::dtype::of<int8_t>();
+    case DataType::INT_32_U:
+        return py::dtype::of<uint32_t>();
+    case DataType::FLOAT_32:
+        return py::dtype::of<float>();
+    case DataType::FLOAT_64:
+        return py::dtype::of<double>();
+    default:
+        return py::dtype::of<uint8_t>();
+    }
+}
+
+// Read-only NumPy view of the samples in their native type, which keeps base alive instead of copying
+py::array channelArray(const ChannelData &data, py::handle base)
+{
+    py::dtype dtype = sampleDtype(data.getDataType());
+    py::array array(dtype, {data.size()}, {static_cast<size_t>(dtype.itemsize())}, data.getBytes().data(), base);
+    array.attr("setflags")(py::arg("write") = false);
+    return array;
+}
+
+// One field of every bin as a NumPy array
+template <typename T>
+py::array_t<T> binArray(const SummaryRange &range, T SummaryBin::*member)
+{
+    py::array_t<T> array(range.bins.size());
+    T *values = array.mutable_data();
+    for (size_t i = 0; i < range.bins.size(); i++)
+    {
+        values[i] = range.bins[i].*member;
+    }
+    return array;
+}
+
 PYBIND11_MODULE(monklib, m)
 {
     py::add_ostream_redirect(m, "ostream_redirect");
@@ -32,6 +89,114 @@ PYBIND11_MODULE(monklib, m)
         .value("ENDIAN_BIG", ByteOrder::ENDIAN_BIG)
         .value("ENDIAN_LITTLE", ByteOrder::ENDIAN_LITTLE);
 
+    py::enum_<ResampleMode>(m, "ResampleMode")
+        .value("HOLD", ResampleMode::HOLD)
+        .value("LINEAR", ResampleMode::LINEAR)
+        .value("POLYPHASE", ResampleMode::POLYPHASE);
+
+    py::enum_<DataType>(m, "DataType")
+        .value("INT_16_S", DataType::INT_16_S)
+        .value("INT_16_U", DataType::INT_16_U)
+        .value("INT_32_S", DataType::INT_32_S)
+        .value("INT_8_U", DataType::INT_8_U)
+        .value("STATUS_16", DataType::STATUS_16)
+        .value("INT_8_S", DataType::INT_8_S)
+        .value("INT_32_U", DataType::INT_32_U)
+        .value("FLOAT_32", DataType::FLOAT_32)
+        .value("FLOAT_64", DataType::FLOAT_64)
+        .value("AHA_8", DataType::AHA_8);
+
+    py::enum_<Lead>(m, "Lead")
+        .value("PACING_STATUS", Lead::PACING_STATUS)
+        .value("PACING_BODY_POS", Lead::PACING_BODY_POS)
+        .value("PACING_BODY_MVMNT", Lead::PACING_BODY_MVMNT)
+        .value("PACING_RESP", Lead::PACING_RESP)
+        .value("PACING_IRW", Lead::PACING_IRW)
+        .value("PACING_BP", Lead::PACING_BP)
+        .value("PACING_SPO2", Lead::PACING_SPO2)
+        .value("PACING_ECG1", Lead::PACING_ECG1)
+        .value("PACING_ECG2", Lead::PACING_ECG2)
+        .value("PACING_ECG3", Lead::PACING_ECG3)
+        .value("PACING_ECG4", Lead::PACING_ECG4)
+        .value("ECG_I", Lead::ECG_I)
+        .value("ECG_II", Lead::ECG_II)
+        .value("ECG_III", Lead::ECG_III)
+        .value("ECG_AVR", Lead::ECG_AVR)
+        .value("ECG_AVL", Lead::ECG_AVL)
+        .value("ECG_AVF", Lead::ECG_AVF)
+        .value("ECG_V1", Lead::ECG_V1)
+        .value("ECG_V2", Lead::ECG_V2)
+        .value("ECG_V3", Lead::ECG_V3)
+        .value("ECG_V4", Lead::ECG_V4)
+        .value("ECG_V5", Lead::ECG_V5)
+        .value("ECG_V6", Lead::ECG_V6)
+        .value("ECG_V", Lead::ECG_V)
+        .value("ECG_MCL", Lead::ECG_MCL)
+        .value("ECG_ECG1", Lead::ECG_ECG1)
+        .value("ECG_ECG2", Lead::ECG_ECG2)
+        .value("ECG_TRACE_1", Lead::ECG_TRACE_1)
+        .value("ECG_TRACE_2", Lead::ECG_TRACE_2)
+        .value("RESP", Lead::RESP)
+        .value("RESP_IMP", Lead::RESP_IMP)
+        .value("RESP_THERM", Lead::RESP_THERM)
+        .value("SPO2", Lead::SPO2)
+        .value("SPO2_2", Lead::SPO2_2)
+        .value("ART", Lead::ART)
+        .value("ART_2", Lead::ART_2)
+        .value("RAD", Lead::RAD)
+        .value("DORS", Lead::DORS)
+        .value("AO", Lead::AO)
+        .value("FEM", Lead::FEM)
+        .value("UA", Lead::UA)
+        .value("UV", Lead::UV)
+        .value("PAP", Lead::PAP)
+        .value("CVP", Lead::CVP)
+        .value("RAP", Lead::RAP)
+        .value("RVP", Lead::RVP)
+        .value("LAP", Lead::LAP)
+        .value("LVP", Lead::LVP)
+        .value("ICP", Lead::ICP)
+        .value("ICP_2", Lead::ICP_2)
+        .value("ICP_3", Lead::ICP_3)
+        .value("ICP_4", Lead::ICP_4)
+        .value("PRESS", Lead::PRESS)
+        .value("PRESS_2", Lead::PRESS_2)
+        .value("PRESS_3", Lead::PRESS_3)
+        .value("PRESS_4", Lead::PRESS_4)
+        .value("PRESS_5", Lead::PRESS_5)
+        .value("PRESS_6", Lead::PRESS_6)
+        .value("PRESS_7", Lead::PRESS_7)
+        .value("PRESS_8", Lead::PRESS_8)
+        .value("CO2", Lead::CO2)
+        .value("FIO2", Lead::FIO2)
+        .value("FLOW_1", Lead::FLOW_1)
+        .value("FLOW_2", Lead::FLOW_2)
+        .value("PAW", Lead::PAW)
+        .value("VENT_1", Lead::VENT_1)
+        .value("VENT_2", Lead::VENT_2)
+        .value("VENT_3", Lead::VENT_3)
+        .value("ANES_1", Lead::ANES_1)
+        .value("ANES_2", Lead::ANES_2)
+        .value("ANES_3", Lead::ANES_3)
+        .value("ANES_4", Lead::ANES_4)
+        .value("ANES_5", Lead::ANES_5)
+        .value("ANES_6", Lead::ANES_6)
+        .value("ANES_7", Lead::ANES_7)
+        .value("BIS", Lead::BIS)
+        .value("EXT_9000_1", Lead::EXT_9000_1)
+        .value("EXT_9000_2", Lead::EXT_9000_2)
+        .value("EXT_9000_3", Lead::EXT_9000_3)
+        .value("EXT_9000_4", Lead::EXT_9000_4)
+        .value("EEG", Lead::EEG)
+        .value("EEG_2", Lead::EEG_2)
+        .value("PICCO", Lead::PICCO)
+        .value("EEG_3", Lead::EEG_3)
+        .value("EEG_4", Lead::EEG_4)
+        .value("EEG_5", Lead::EEG_5)
+        .value("EEG_6", Lead::EEG_6)
+        .value("EEG_7", Lead::EEG_7)
+        .value("EEG_8", Lead::EEG_8);
+
     py::class_<NIBPEvent>(m, "NIBPEvent")
         .def_readonly("eventCode", &NIBPEvent::eventCode)
         .def_readonly("startTime", &NIBPEvent::startTime)
@@ -39,6 +204,8 @@ PYBIND11_MODULE(monklib, m)
         .def_readonly("information", &NIBPEvent::information);
 
     py::class_<Channel>(m, "Channel")
+        .def_property_readonly("lead", [](const Channel &c)
+                               { return c.leadInfo.lead; })
         .def_property_readonly("attribute", [](const Channel &c)
                                { return c.leadInfo.attribute; })
         .def_property_readonly("samplingResolution", [](const Channel &c)
@@ -47,7 +214,17 @@ PYBIND11_MODULE(monklib, m)
                                { return c.samplingResolution; })
         .def_readonly("samplingInterval", &Channel::samplingIntervalString)
         .def_readonly("blockLength", &Channel::blockLength)
-        .def_readonly("data", &Channel::data);
+        .def_readonly("dataType", &Channel::dataType)
+        .def_property_readonly("data", [](py::object self)
+                               { return channelArray(self.cast<const Channel &>().data, self); })
+        .def("toDoubles", [](const Channel &c)
+             {
+                 std::vector<double> values = c.data.toDoubles();
+                 return py::array_t<double>(values.size(), values.data()); }, "Get the samples as float64, with missing values as NaN")
+        .def("toPhysical", [](const Channel &c)
+             {
+                 std::vector<double> values = c.data.toPhysical();
+                 return py::array_t<double>(values.size(), values.data()); }, "Get the samples as float64 in physical units, scaled by samplingResolutionValue");
 
     py::class_<Header>(m, "Header")
         .def_readonly("preamble", &Header::preamble)
@@ -64,20 +241,164 @@ PYBIND11_MODULE(monklib, m)
         .def_readonly("events", &Header::events)
         .def_readonly("sequenceCount", &Header::sequenceCount)
         .def_readonly("channelCount", &Header::channelCount)
-        .def_readonly("channels", &Header::channels)
+        .def_property_readonly("channels", [](py::object self)
+                               {
+                                   // Channels are returned as references into the header, so their data is not copied
+                                   const Header &header = self.cast<const Header &>();
+                                   py::list channels;
+                                   for (const Channel &channel : header.channels)
+                                   {
+                                       channels.append(py::cast(&channel, py::return_value_policy::reference_internal, self));
+                                   }
+                                   return channels; })
         .def("__str__", &Header::toString);
 
+    py::class_<ConversionResult>(m, "ConversionResult")
+        .def_readonly("input", &ConversionResult::input)
+        .def_readonly("output", &ConversionResult::output)
+        .def_readonly("success", &ConversionResult::success)
+        .def_readonly("error", &ConversionResult::error)
+        .def("__repr__", [](const ConversionResult &result)
+             { return "<ConversionResult " + result.input + (result.success ? " -> " + result.output : ": " + result.error) + ">"; });
+
+    py::class_<SummaryRange>(m, "SummaryRange")
+        .def_readonly("level", &SummaryRange::level)
+        .def_readonly("binLength", &SummaryRange::binLength)
+        .def_readonly("firstBin", &SummaryRange::firstBin)
+        .def_readonly("binDuration", &SummaryRange::binDuration)
+        .def_readonly("start", &SummaryRange::start)
+        .def_property_readonly("min", [](const SummaryRange &range)
+                               { return binArray(range, &SummaryBin::min); })
+        .def_property_readonly("max", [](const SummaryRange &range)
+                               { return binArray(range, &SummaryBin::max); })
+        .def_property_readonly("mean", [](const SummaryRange &range)
+                               { return binArray(range, &SummaryBin::mean); })
+        .def_property_readonly("count", [](const SummaryRange &range)
+                               { return binArray(range, &SummaryBin::count); })
+        .def("__len__", [](const SummaryRange &range)
+             { return range.bins.size(); });
+
+    py::class_<SamplePosition>(m, "SamplePosition")
+        .def_readonly("sequence", &SamplePosition::sequence)
+        .def_readonly("sample", &SamplePosition::sample);
+
     py::class_<NihonKohdenData>(m, "Data")
-        .def(py::init<const std::string &>())
+        .def(py::init<const std::string &, bool>(), py::arg("fileName"), py::arg("useIndex") = false,
+             "Open a file. With useIndex, the header is read from the sidecar index next to the file, which is written or rebuilt when missing or stale")
+        .def("isIndexed", &NihonKohdenData::isIndexed, "Whether the data was opened from a valid sidecar index without parsing")
         .def("getHeader", &NihonKohdenData::getHeader,
-             py::return_value_policy::copy, "Get the header of the data")
+             py::return_value_policy::reference_internal, "Get the header of the data, decoded once and shared until the data is anonymized")
+        .def("getMetadata", &NihonKohdenData::getMetadata,
+             py::return_value_policy::copy, "Get the header of the data without decoding channel data")
+        .def("getChannelData", [](py::object self, size_t index)
+             { return channelArray(self.cast<const NihonKohdenData &>().getChannelData(index), self); },
+             py::arg("index"), "Get the samples of the channel at index as a read-only NumPy array of their native type, decoded on first request")
+        .def("getWaveform", [](py::object self)
+             {
+                 // The memoryview exports a uint8 array whose base keeps the data object alive
+                 ByteView waveform = self.cast<const NihonKohdenData &>().getWaveform();
+                 py::array_t<uint8_t> array({waveform.size()}, {sizeof(uint8_t)}, waveform.data(), self);
+                 array.attr("setflags")(py::arg("write") = false);
+                 PyObject *view = PyMemoryView_FromObject(array.ptr());
+                 if (!view)
+                 {
+                     throw py::error_already_set();
+                 }
+                 return py::reinterpret_steal<py::memoryview>(view); },
+             "Get the raw waveform payload as a read-only memoryview, for custom decoding")
+        .def("getSamplePosition", &NihonKohdenData::getSamplePosition, py::arg("index"), py::arg("time"),
+             "Get the sequence and sample of the channel at index taken at or before time, in seconds")
+        .def("getSampleCount", &NihonKohdenData::getSampleCount, py::arg("index"), "Get the number of samples of the channel at index")
+        .def("readSamples", [](const NihonKohdenData &data, size_t index, uint64_t startSample, uint64_t count, py::object out)
+             {
+                 py::array_t<double> output;
+                 if (out.is_none())
+                 {
+                     output = py::array_t<double>(count);
+                 }
+                 else
+                 {
+                     // Decoded in place, so the buffer must be a writable contiguous float64 array, never a converted copy
+                     if (!py::isinstance<py::array>(out))
+                     {
+                         throw py::type_error("out must be a NumPy array");
+                     }
+                     py::array array = py::reinterpret_borrow<py::array>(out);
+                     if (!array.dtype().is(py::dtype::of<double>()) || !(array.flags() & py::array::c_style) || !array.writeable() || static_cast<uint64_t>(array.size()) < count)
+                     {
+                         throw py::value_error("out must be a writable contiguous float64 array of at least count samples");
+                     }
+                     output = py::reinterpret_borrow<py::array_t<double>>(array);
+                 }
+                 double *buffer = output.mutable_data();
+                 {
+                     py::gil_scoped_release release;
+                     data.readSamples(index, startSample, count, buffer);
+                 }
+                 return output; },
+             py::arg("index"), py::arg("startSample"), py::arg("count"), py::arg("out") = py::none(),
+             "Decode count samples of the channel at index from startSample as float64, with missing values as NaN, into out or a new array")
         .def("anonymize", &NihonKohdenData::anonymize, "Anonymize the data")
-        .def("setChannelSelection", &NihonKohdenData::setChannelSelection, "Set the channel selection at index to active")
+        .def("setChannelSelection", py::overload_cast<Lead, bool>(&NihonKohdenData::setChannelSelection), py::arg("lead"), py::arg("active"),
+             "Set the selection of every channel of the lead to active")
+        .def("setChannelSelection", py::overload_cast<int, bool>(&NihonKohdenData::setChannelSelection), py::arg("index"), py::arg("active"),
+             "Set the channel selection at index to active")
+        .def("getChannelSelection", &NihonKohdenData::getChannelSelection, "Get the selection of each channel")
         .def("setIntervalSelection", &NihonKohdenData::setIntervalSelection, "Set the interval selection in seconds (start = 0, end = 0). Setting end to 0 will select the remaining data")
+        .def("setResampling", &NihonKohdenData::setResampling, py::arg("samplingInterval"), py::arg("mode") = ResampleMode::LINEAR,
+             "Align the selected channels on rows every samplingInterval seconds in the outputs, 0 keeps the sampling of each channel")
+        .def("getResampledRowCount", &NihonKohdenData::getResampledRowCount, "Get the number of resampled rows within the interval selection")
+        .def("resample", [](const NihonKohdenData &data)
+             {
+                 uint64_t rowCount = data.getResampledRowCount();
+                 size_t width = 1;
+                 for (bool selected : data.getChannelSelection())
+                 {
+                     width += selected;
+                 }
+                 py::array_t<double> rows({static_cast<size_t>(rowCount), width});
+                 double *output = rows.mutable_data();
+                 {
+                     py::gil_scoped_release release;
+                     data.readResampled(0, rowCount, output);
+                 }
+                 return rows; },
+             "Get the resampled rows of the interval selection as a float64 array of the time followed by the selected channels")
         .def("writeToBinary", &NihonKohdenData::writeToBinary, "Write the data to a binary file")
-        .def("writeToCsv", &NihonKohdenData::writeToCsv, "Write the data to a csv file");
+        .def("writeToCsv", &NihonKohdenData::writeToCsv, py::arg("fileName"), py::arg("precision") = CsvWriter::defaultPrecision, py::arg("threads") = 1,
+             py::call_guard<py::gil_scoped_release>(),
+             "Write the data to a csv file, with values rounded to precision significant digits. threads = 0 uses every core")
+        .def("writeToArrow", &NihonKohdenData::writeToArrow, py::arg("fileName"), py::arg("sequencesPerBatch") = 10,
+             py::call_guard<py::gil_scoped_release>(),
+             "Write the selected channels to an Arrow IPC file, with one record batch per sequencesPerBatch sequences");
+
+    py::class_<SummaryPyramid>(m, "SummaryPyramid")
+        .def(py::init([](const NihonKohdenData &data, uint32_t baseBinLength, uint32_t levelFactor)
+                      { return SummaryPyramid(data, {baseBinLength, levelFactor}); }),
+             py::arg("data"), py::arg("baseBinLength") = SummaryOptions().baseBinLength, py::arg("levelFactor") = SummaryOptions().levelFactor,
+             py::call_guard<py::gil_scoped_release>(), "Build the min, max and mean summary of every channel in one pass over the waveform")
+        .def_static("read", &SummaryPyramid::read, py::arg("fileName"), py::arg("data"),
+                    "Read a summary written by write, which must have been built from the file of data as it is now")
+        .def("matches", &SummaryPyramid::matches, py::arg("data"), "Check that the summary was built from the file of data as it is now")
+        .def("write", &SummaryPyramid::write, py::arg("fileName"), "Write the summary to a file")
+        .def("getChannelCount", &SummaryPyramid::getChannelCount)
+        .def("getLevelCount", &SummaryPyramid::getLevelCount, py::arg("channel"), "Get the number of stored levels of the channel")
+        .def("getBinLength", &SummaryPyramid::getBinLength, py::arg("level"), "Get the number of samples per bin of the level, 1 for level 0")
+        .def("query", &SummaryPyramid::query, py::arg("channel"), py::arg("start"), py::arg("end"), py::arg("pixels"), py::arg("data") = nullptr,
+             py::call_guard<py::gil_scoped_release>(),
+             "Get the bins of the channel from start to end in seconds at the coarsest level with at least one bin per pixel, reading raw samples from data at the finest zoom");
 
     m.def("get_header", &getHeader, "Get the header of the file");
     m.def("print_header", &printFileHeader, "Print the header of the file");
-    m.def("convert_to_csv", &convertFileToCsv, "Convert the file to a csv file");
+    m.def("convert_to_csv", &convertFileToCsv, py::arg("filename"), py::arg("outputFilename"), py::arg("precision") = CsvWriter::defaultPrecision, py::arg("threads") = 1,
+          py::call_guard<py::gil_scoped_release>(), "Convert the file to a csv file");
+
+    m.def("convert_many", &convertFiles, py::arg("inputs"), py::arg("outputDirectory"), py::arg("format") = "csv", py::arg("threads") = 0, py::arg("memoryLimit") = defaultBatchMemoryLimit,
+          py::call_guard<py::gil_scoped_release>(),
+          "Convert many files into a directory on a pool of threads, returning the result of each file. format is \"csv\" or \"arrow\"");
+
+    m.def("anonymize_file", py::overload_cast<const std::string &>(&anonymizeFile), py::arg("filename"),
+          py::call_guard<py::gil_scoped_release>(), "Anonymize the file in place, overwriting only the identifying fields");
+    m.def("anonymize_file", py::overload_cast<const std::string &, const std::string &>(&anonymizeFile), py::arg("filename"), py::arg("outputFilename"),
+          py::call_guard<py::gil_scoped_release>(), "Copy the file and anonymize the copy, leaving the input unchanged");
 }
@@ -1,6 +1,7 @@
 import pytest
 import monklib
 import os
+import numpy as np
 
 @pytest.fixture
 def test_file_path():
@@ -85,3 +86,231 @@ def test_write_to_csv(test_file_path, tmp_path):
         first_line = f.readline().strip()
     expected_header = "Time: (s), ECG II: 2x10^-6 (V), ECG V5: 2x10^-6 (V), ART: 125x10^-3 (mmHg), PAP: 125x10^-3 (mmHg), CVP: 125x10^-3 (mmHg), Pacing Status: N/A"
     assert first_line == expected_header
+
+def test_get_metadata(test_file_path):
+    # Metadata is available without decoding channel data
+    data = monklib.Data(test_file_path)
+    metadata = data.getMetadata()
+    assert metadata.sequenceCount == 12
+    assert len(metadata.channels) == 6
+    assert all(len(channel.data) == 0 for channel in metadata.channels)
+
+def test_get_channel_data(test_file_path):
+    # Channel data is decoded on request
+    data = monklib.Data(test_file_path)
+    metadata = data.getMetadata()
+    samples = data.getChannelData(0)
+    assert len(samples) == metadata.sequenceCount * metadata.channels[0].blockLength
+    with pytest.raises(RuntimeError):
+        data.getChannelData(6)
+
+def test_get_header_cached(test_file_path):
+    # The header is shared with the data object and outlives it
+    data = monklib.Data(test_file_path)
+    header = data.getHeader()
+    channels = header.channels
+    del data
+    assert header.sequenceCount == 12
+    assert len(channels[0].data) == header.sequenceCount * channels[0].blockLength
+
+def test_write_to_csv_precision(test_file_path, tmp_path):
+    # Timestamps and values are written with the requested number of significant digits
+    data = monklib.Data(test_file_path)
+    csv_path = tmp_path / "output.csv"
+    data.writeToCsv(str(csv_path), precision=3)
+    with open(csv_path, "r") as f:
+        f.readline()
+        f.readline()
+        timestamp = f.readline().split(",")[0]
+    assert len(timestamp.replace(".", "")) <= 3
+    with pytest.raises(RuntimeError):
+        data.writeToCsv(str(csv_path), precision=0)
+
+def test_write_to_csv_threads(test_file_path, tmp_path):
+    # Parallel conversion writes the same file as a single thread
+    data = monklib.Data(test_file_path)
+    single_path = tmp_path / "single.csv"
+    threads_path = tmp_path / "threads.csv"
+    data.writeToCsv(str(single_path))
+    data.writeToCsv(str(threads_path), threads=4)
+    assert threads_path.read_bytes() == single_path.read_bytes()
+
+def test_channel_data_numpy(test_file_path):
+    # Channel samples are read-only NumPy views that keep the data object alive
+    data = monklib.Data(test_file_path)
+    header = data.getHeader()
+    samples = data.getChannelData(0)
+    assert isinstance(samples, np.ndarray)
+    assert samples.dtype == np.int16
+    assert not samples.flags.writeable
+    assert np.shares_memory(samples, header.channels[0].data)
+    del data, header
+    assert samples.shape == (12 * 15000,)
+
+def test_get_waveform(test_file_path):
+    # The raw waveform payload is exposed without copying
+    data = monklib.Data(test_file_path)
+    waveform = data.getWaveform()
+    assert isinstance(waveform, memoryview)
+    assert waveform.readonly
+    assert waveform.nbytes == 1620000
+
+def test_channel_conversion(test_file_path):
+    # Samples are converted to floats or physical units on request
+    data = monklib.Data(test_file_path)
+    channel = data.getHeader().channels[2]
+    assert channel.dataType == monklib.DataType.INT_16_S
+    assert channel.data[0] == 774
+    values = channel.toDoubles()
+    assert values.dtype == np.float64
+    assert values[0] == 774
+    assert channel.toPhysical()[0] == pytest.approx(774 * 0.125)
+
+def test_get_sample_position(test_file_path):
+    # Times are located to a sequence and a sample within it
+    data = monklib.Data(test_file_path)
+    position = data.getSamplePosition(0, 100.502)
+    assert position.sequence == 1
+    assert position.sample == 10125
+    with pytest.raises(RuntimeError):
+        data.getSamplePosition(0, -1)
+
+def test_set_channel_selection_by_lead(test_file_path):
+    # Channels can be selected by lead, and unselected channels are not decoded
+    data = monklib.Data(test_file_path)
+    for index in range(6):
+        data.setChannelSelection(index, False)
+    data.setChannelSelection(monklib.Lead.ART, True)
+    assert data.getChannelSelection() == [False, False, True, False, False, False]
+    header = data.getHeader()
+    assert header.channels[2].lead == monklib.Lead.ART
+    assert len(header.channels[2].data) == 12 * 7500
+    assert len(header.channels[0].data) == 0
+    with pytest.raises(RuntimeError):
+        data.setChannelSelection(6, True)
+
+def test_write_to_arrow(test_file_path, tmp_path):
+    # Arrow columns hold the native samples, with nulls where a slower channel has no sample
+    pa = pytest.importorskip("pyarrow")
+    data = monklib.Data(test_file_path)
+    arrow_path = tmp_path / "output.arrow"
+    data.writeToArrow(str(arrow_path), sequencesPerBatch=5)
+    reader = pa.ipc.open_file(str(arrow_path))
+    assert reader.num_record_batches == 3
+    table = reader.read_all()
+    assert table.column_names[0] == "Time"
+    assert table.num_rows == 12 * 15000
+    header = data.getHeader()
+    ecg = table.column(1).to_numpy()
+    assert np.array_equal(ecg[:100], header.channels[0].data[:100])
+    art = table.column(3)
+    assert art.null_count >= 12 * 7500
+    assert art[1].as_py() is None
+    assert table.schema.field(3).metadata[b"scale"] == b"0.125"
+
+def test_convert_many(test_file_path, tmp_path):
+    # Files are converted as by convert_to_csv, and a failed file does not stop the batch
+    output_dir = tmp_path / "output"
+    results = monklib.convert_many([test_file_path, str(tmp_path / "missing.MWF")], str(output_dir), threads=2)
+    assert len(results) == 2
+    assert results[0].success
+    assert not results[1].success
+    assert results[1].error
+    single_path = tmp_path / "single.csv"
+    monklib.convert_to_csv(test_file_path, str(single_path))
+    with open(results[0].output, "rb") as output:
+        assert output.read() == single_path.read_bytes()
+    with pytest.raises(RuntimeError):
+        monklib.convert_many([test_file_path], str(output_dir), format="xml")
+
+def test_anonymize_file(test_file_path, tmp_path):
+    # Anonymizing a copy gives the same file as anonymize and writeToBinary
+    expected_path = tmp_path / "expected.MWF"
+    data = monklib.Data(test_file_path)
+    data.anonymize()
+    data.writeToBinary(str(expected_path))
+    copy_path = tmp_path / "copy.MWF"
+    monklib.anonymize_file(test_file_path, str(copy_path))
+    assert copy_path.read_bytes() == expected_path.read_bytes()
+    in_place_path = tmp_path / "in_place.MWF"
+    in_place_path.write_bytes(open(test_file_path, "rb").read())
+    monklib.anonymize_file(str(in_place_path))
+    assert in_place_path.read_bytes() == expected_path.read_bytes()
+
+def test_use_index(test_file_path, tmp_path):
+    # The second open reads the header from the sidecar index, and a stale index is rebuilt
+    path = tmp_path / "indexed.MWF"
+    path.write_bytes(open(test_file_path, "rb").read())
+    first = monklib.Data(str(path), useIndex=True)
+    assert not first.isIndexed()
+    assert (tmp_path / "indexed.MWF.idx").exists()
+    second = monklib.Data(str(path), useIndex=True)
+    assert second.isIndexed()
+    assert str(second.getMetadata()) == str(first.getMetadata())
+    assert (second.getChannelData(0) == first.getChannelData(0)).all()
+    del first, second
+    monklib.anonymize_file(str(path))
+    third = monklib.Data(str(path), useIndex=True)
+    assert not third.isIndexed()
+    assert third.getMetadata().patientID.strip("\x00") == ""
+
+def test_read_samples(test_file_path):
+    # A window spanning two sequences matches the decoded channel, and out is filled in place
+    data = monklib.Data(test_file_path)
+    expected = data.getHeader().channels[2].toDoubles()
+    assert data.getSampleCount(2) == len(expected)
+    window = data.readSamples(2, 7400, 200)
+    assert window.dtype == np.float64
+    assert np.array_equal(window, expected[7400:7600], equal_nan=True)
+    out = np.zeros(300)
+    assert data.readSamples(2, 0, 300, out=out) is out
+    assert np.array_equal(out, expected[:300], equal_nan=True)
+    with pytest.raises(ValueError):
+        data.readSamples(2, 0, 10, out=np.zeros(10, dtype=np.float32))
+    with pytest.raises(RuntimeError):
+        data.readSamples(2, len(expected) - 5, 10)
+
+def test_summary_pyramid(test_file_path, tmp_path):
+    # Whole recording at display width reads summary bins, short windows read raw samples
+    data = monklib.Data(test_file_path)
+    summary = monklib.SummaryPyramid(data)
+    assert summary.getChannelCount() == 6
+    overview = summary.query(0, 0, 720, 1000)
+    assert overview.level == 2
+    assert 1000 <= len(overview) <= 4000
+    samples = data.getHeader().channels[0].toDoubles()
+    assert overview.min[0] == np.nanmin(samples[:64])
+    assert overview.max[0] == np.nanmax(samples[:64])
+    detail = summary.query(0, 100, 101, 1000, data)
+    assert detail.level == 0
+    assert np.array_equal(detail.mean, samples[25000:25250].astype(np.float32), equal_nan=True)
+    path = str(tmp_path / "summary.sum")
+    summary.write(path)
+    read = monklib.SummaryPyramid.read(path, data)
+    assert read.matches(data)
+    assert np.array_equal(read.query(0, 0, 720, 1000).max, overview.max, equal_nan=True)
+    other_path = str(tmp_path / "anonymized.MWF")
+    monklib.anonymize_file(test_file_path, other_path)
+    other = monklib.Data(other_path)
+    assert not read.matches(other)
+    with pytest.raises(RuntimeError):
+        monklib.SummaryPyramid.read(path, other)
+
+def test_resample(test_file_path, tmp_path):
+    # Every channel has a value on every row, slower channels interpolated between their samples
+    data = monklib.Data(test_file_path)
+    data.setResampling(0.004, monklib.ResampleMode.LINEAR)
+    rows = data.resample()
+    assert rows.shape == (180000, 7)
+    header = data.getHeader()
+    assert np.allclose(rows[:10, 0], np.arange(10) * 0.004)
+    assert np.array_equal(rows[:, 1], header.channels[0].toDoubles(), equal_nan=True)
+    art = header.channels[2].toDoubles()
+    assert np.array_equal(rows[0:20:2, 3], art[:10], equal_nan=True)
+    data.setIntervalSelection(100, 101)
+    assert data.getResampledRowCount() == 251
+    output = tmp_path / "resampled.csv"
+    data.writeToCsv(str(output))
+    lines = output.read_text().splitlines()
+    assert len(lines) == 252
+    assert all(", ," not in line for line in lines)
@@ -0,0 +1,83 @@
+#include "BenchmarkData.h"
+#include "FileManager.h"
+#include "MFERGenerator.h"
+#include <filesystem>
+#include <map>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+const ByteVector &getTestFile()
+{
+    static const ByteVector file = FileManager::readBinaryFile(MONK_BENCH_DATA_FILE);
+    return file;
+}
+
+const ByteVector &getSyntheticFile(uint16_t scale)
+{
+    static std::map<uint16_t, ByteVector> files;
+    auto found = files.find(scale);
+    if (found != files.end())
+    {
+        return found->second;
+    }
+    GeneratorOptions options;
+    options.sequenceCount = static_cast<uint16_t>(options.sequenceCount * scale);
+    options.missingDensity = 0.001;
+    options.eventCount = 4;
+    return files.emplace(scale, generateMFER(options)).first->second;
+}
+
+const ByteVector &getInput(int64_t scale)
+{
+    return scale == 1 ? getTestFile() : getSyntheticFile(static_cast<uint16_t>(scale));
+}
+
+uint64_t getSampleCount(const Header &header)
+{
+    uint64_t samples = 0;
+    for (const Channel &channel : header.channels)
+    {
+        samples += static_cast<uint64_t>(header.sequenceCount) * channel.blockLength;
+    }
+    return samples;
+}
+
+std::string getTemporaryPath(const std::string &name)
+{
+    return (std::filesystem::temp_directory_path() / ("monk_bench_" + name)).string();
+}
+
+uint64_t getPeakMemory()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss; // Bytes on macOS
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024; // Kilobytes on Linux
+#endif
+#endif
+}
+
+void setThroughput(benchmark::State &state, uint64_t bytes, uint64_t samples)
+{
+    if (bytes > 0)
+    {
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+    }
+    if (samples > 0)
+    {
+        state.counters["samples"] = benchmark::Counter(static_cast<double>(state.iterations() * samples), benchmark::Counter::kIsRate);
+    }
+    state.counters["peak_memory"] = benchmark::Counter(static_cast<double>(getPeakMemory()), benchmark::Counter::kDefaults, benchmark::Counter::kIs1024);
+}
@@ -0,0 +1,27 @@
+#ifndef BENCHMARKDATA_H
+#define BENCHMARKDATA_H
+
+#include "ByteVector.h"
+#include "NihonKohdenData.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <string>
+
+// Contents of resources/test-file.MWF, read once
+const ByteVector &getTestFile();
+
+// Generated recording with the channels of the test file and scale times as many sequences, for throughput on large inputs
+const ByteVector &getSyntheticFile(uint16_t scale = 16);
+
+const ByteVector &getInput(int64_t scale); // Test file for a scale of 1, otherwise the synthetic file
+
+uint64_t getSampleCount(const Header &header); // Samples of every channel
+
+std::string getTemporaryPath(const std::string &name); // Path in the temporary directory for output files
+
+uint64_t getPeakMemory(); // Peak resident set size of the process in bytes
+
+// Sets bytes/s, samples/s and the peak memory counters of a benchmark
+void setThroughput(benchmark::State &state, uint64_t bytes, uint64_t samples);
+
+#endif // BENCHMARKDATA_H
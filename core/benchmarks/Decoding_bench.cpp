@@ -0,0 +1,108 @@
+#include "BenchmarkData.h"
+#include "MFERData.h"
+#include "NihonKohdenData.h"
+#include "SampleDecoder.h"
+#include "SummaryPyramid.h"
+#include <random>
+#include <vector>
+
+// Decoding of one million samples of each data type, with each kernel supported by the CPU
+static void BM_DecodeSamples(benchmark::State &state)
+{
+    DataType dataType = static_cast<DataType>(state.range(0));
+    DecodeKernel kernel = static_cast<DecodeKernel>(state.range(1));
+    ByteOrder byteOrder = state.range(2) ? ByteOrder::ENDIAN_BIG : ByteOrder::ENDIAN_LITTLE;
+    if (!isDecodeKernelSupported(kernel))
+    {
+        state.SkipWithError(("Unsupported kernel " + decodeKernelName(kernel)).c_str());
+        return;
+    }
+
+    const size_t count = 1 << 20;
+    size_t size = getDataTypeSize(dataType);
+    std::vector<uint8_t> source(count * size);
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> byte(0, 255);
+    for (uint8_t &value : source)
+    {
+        value = static_cast<uint8_t>(byte(generator));
+    }
+    std::vector<double> output(count);
+
+    for (auto _ : state)
+    {
+        decodeSamples(source.data(), count, dataType, byteOrder, output.data(), kernel);
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetLabel(decodeKernelName(kernel));
+    setThroughput(state, source.size(), count);
+}
+
+static void decodeArguments(benchmark::internal::Benchmark *benchmark)
+{
+    benchmark->ArgNames({"type", "kernel", "big_endian"});
+    for (DataType dataType : {DataType::INT_16_S, DataType::INT_16_U, DataType::INT_32_S, DataType::INT_8_U, DataType::STATUS_16,
+                              DataType::INT_8_S, DataType::INT_32_U, DataType::FLOAT_32, DataType::FLOAT_64})
+    {
+        for (DecodeKernel kernel : {DecodeKernel::SCALAR, DecodeKernel::SSE2, DecodeKernel::AVX2})
+        {
+            for (int bigEndian : {0, 1})
+            {
+                benchmark->Args({static_cast<int64_t>(dataType), static_cast<int64_t>(kernel), bigEndian});
+            }
+        }
+    }
+}
+BENCHMARK(BM_DecodeSamples)->Apply(decodeArguments);
+
+// Random windows of one second of a 250 Hz channel, as read by a viewer scrolling through a recording
+static void BM_ReadSamples(benchmark::State &state)
+{
+    NihonKohdenData data(getInput(state.range(0)));
+    uint64_t count = 250;
+    uint64_t sampleCount = data.getSampleCount(0);
+    std::vector<double> output(count);
+    std::mt19937_64 generator(42);
+    std::uniform_int_distribution<uint64_t> start(0, sampleCount - count);
+
+    for (auto _ : state)
+    {
+        data.readSamples(0, start(generator), count, output.data());
+        benchmark::DoNotOptimize(output.data());
+    }
+    setThroughput(state, count * getDataTypeSize(data.getMetadata().channels[0].dataType), count);
+}
+BENCHMARK(BM_ReadSamples)->ArgName("scale")->Arg(1)->Arg(16);
+
+// Summary of every channel, the single pass over the waveform
+static void BM_BuildSummary(benchmark::State &state)
+{
+    NihonKohdenData data(getInput(state.range(0)));
+    for (auto _ : state)
+    {
+        SummaryPyramid pyramid(data);
+        benchmark::DoNotOptimize(pyramid.getLevelCount(0));
+    }
+    setThroughput(state, data.getWaveform().size(), getSampleCount(data.getMetadata()));
+}
+BENCHMARK(BM_BuildSummary)->ArgName("scale")->Arg(1)->Arg(16)->Unit(benchmark::kMillisecond);
+
+// Random ranges of a 250 Hz channel from ten seconds to the whole recording, drawn 2000 pixels wide
+static void BM_QuerySummary(benchmark::State &state)
+{
+    NihonKohdenData data(getInput(state.range(0)));
+    SummaryPyramid pyramid(data);
+    double duration = data.getSampleCount(0) * data.getMetadata().channels[0].samplingInterval;
+    std::mt19937_64 generator(42);
+    std::uniform_real_distribution<double> position(0, 1);
+
+    for (auto _ : state)
+    {
+        double length = 10 + position(generator) * (duration - 10);
+        double start = position(generator) * (duration - length);
+        SummaryRange range = pyramid.query(0, start, start + length, 2000, &data);
+        benchmark::DoNotOptimize(range.bins.data());
+    }
+}
+BENCHMARK(BM_QuerySummary)->ArgName("scale")->Arg(1)->Arg(16)->Unit(benchmark::kMicrosecond);
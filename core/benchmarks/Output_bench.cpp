@@ -0,0 +1,89 @@
+#include "BenchmarkData.h"
+#include "NihonKohdenData.h"
+#include <filesystem>
+
+// Bytes per second are of the input file, so outputs of different sizes can be compared
+static void BM_WriteToCsv(benchmark::State &state)
+{
+    const ByteVector &file = getInput(state.range(0));
+    NihonKohdenData data{ByteView(file)};
+    data.setVerbose(false);
+    std::string output = getTemporaryPath("output.csv");
+    for (auto _ : state)
+    {
+        data.writeToCsv(output, CsvWriter::defaultPrecision, static_cast<unsigned int>(state.range(1)));
+    }
+    setThroughput(state, file.size(), getSampleCount(data.getMetadata()));
+    state.counters["output_size"] = static_cast<double>(std::filesystem::file_size(output));
+    std::filesystem::remove(output);
+}
+BENCHMARK(BM_WriteToCsv)->ArgNames({"scale", "threads"})->Args({1, 1})->Args({16, 1})->Args({16, 0})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_WriteToArrow(benchmark::State &state)
+{
+    const ByteVector &file = getInput(state.range(0));
+    NihonKohdenData data{ByteView(file)};
+    data.setVerbose(false);
+    std::string output = getTemporaryPath("output.arrow");
+    for (auto _ : state)
+    {
+        data.writeToArrow(output);
+    }
+    setThroughput(state, file.size(), getSampleCount(data.getMetadata()));
+    state.counters["output_size"] = static_cast<double>(std::filesystem::file_size(output));
+    std::filesystem::remove(output);
+}
+BENCHMARK(BM_WriteToArrow)->ArgName("scale")->Arg(1)->Arg(16)->Unit(benchmark::kMillisecond);
+
+static void BM_WriteToBinary(benchmark::State &state)
+{
+    const ByteVector &file = getInput(state.range(0));
+    NihonKohdenData data{ByteView(file)};
+    std::string output = getTemporaryPath("output.MWF");
+    for (auto _ : state)
+    {
+        data.writeToBinary(output);
+    }
+    setThroughput(state, file.size(), 0);
+    std::filesystem::remove(output);
+}
+BENCHMARK(BM_WriteToBinary)->ArgName("scale")->Arg(1)->Arg(16)->Unit(benchmark::kMillisecond);
+
+// Csv of every channel resampled to 500 Hz, by mode
+static void BM_WriteToCsvResampled(benchmark::State &state)
+{
+    const ByteVector &file = getInput(state.range(0));
+    ResampleMode mode = static_cast<ResampleMode>(state.range(1));
+    NihonKohdenData data{ByteView(file)};
+    data.setVerbose(false);
+    data.setResampling(0.002, mode);
+    std::string output = getTemporaryPath("output-resampled.csv");
+    for (auto _ : state)
+    {
+        data.writeToCsv(output, CsvWriter::defaultPrecision, 0);
+    }
+    state.SetLabel(getResampleModeName(mode));
+    setThroughput(state, file.size(), getSampleCount(data.getMetadata()));
+    state.counters["output_size"] = static_cast<double>(std::filesystem::file_size(output));
+    std::filesystem::remove(output);
+}
+BENCHMARK(BM_WriteToCsvResampled)->ArgNames({"scale", "mode"})->Args({1, 0})->Args({1, 1})->Args({1, 2})->Args({16, 2})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Rows of every channel resampled to 500 Hz into memory, as returned to NumPy
+static void BM_ReadResampled(benchmark::State &state)
+{
+    const ByteVector &file = getInput(state.range(0));
+    ResampleMode mode = static_cast<ResampleMode>(state.range(1));
+    NihonKohdenData data{ByteView(file)};
+    data.setResampling(0.002, mode);
+    uint64_t rowCount = data.getResampledRowCount();
+    std::vector<double> rows(rowCount * (data.getMetadata().channels.size() + 1));
+    for (auto _ : state)
+    {
+        data.readResampled(0, rowCount, rows.data());
+        benchmark::DoNotOptimize(rows.data());
+    }
+    state.SetLabel(getResampleModeName(mode));
+    setThroughput(state, file.size(), getSampleCount(data.getMetadata()));
+}
+BENCHMARK(BM_ReadResampled)->ArgNames({"scale", "mode"})->Args({1, 0})->Args({1, 1})->Args({1, 2})->Unit(benchmark::kMillisecond);
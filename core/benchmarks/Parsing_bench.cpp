@@ -0,0 +1,124 @@
+#include "BenchmarkData.h"
+#include "DataStack.h"
+#include "MFERDataCollection.h"
+#include "NihonKohdenData.h"
+
+// Reading big-endian integers of tag lengths and contents
+static void BM_ByteViewToInt(benchmark::State &state)
+{
+    ByteView file(getTestFile());
+    size_t width = static_cast<size_t>(state.range(0));
+    size_t count = file.size() / width;
+    for (auto _ : state)
+    {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            sum += ByteView(file.data() + i * width, width).toInt<uint64_t>();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    setThroughput(state, count * width, 0);
+}
+BENCHMARK(BM_ByteViewToInt)->ArgName("width")->Arg(1)->Arg(2)->Arg(4)->Arg(8);
+
+// Reading fixed width values through the bounds checked cursor
+static void BM_DataStackPopValue(benchmark::State &state)
+{
+    ByteView file(getTestFile());
+    size_t count = file.size() / sizeof(uint16_t);
+    for (auto _ : state)
+    {
+        DataStack stack(file);
+        uint64_t sum = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            sum += stack.pop_value<uint16_t>();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    setThroughput(state, count * sizeof(uint16_t), 0);
+}
+BENCHMARK(BM_DataStackPopValue);
+
+// Parsing every tag, with the waveform referenced in place as when reading a mapped file
+static void BM_ParseTags(benchmark::State &state)
+{
+    const ByteVector &file = getTestFile();
+    std::shared_ptr<const void> source(&file, [](const void *) {});
+    size_t tags = 0;
+    for (auto _ : state)
+    {
+        MFERDataCollection collection(ByteView(file), source);
+        tags = collection.size();
+        benchmark::DoNotOptimize(tags);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * tags)); // Top level tags, ATT counts as one
+    setThroughput(state, 0, 0);
+}
+BENCHMARK(BM_ParseTags);
+
+// Dispatching every parsed tag to its type, as when collecting header fields
+static void BM_VisitTags(benchmark::State &state)
+{
+    const ByteVector &file = getTestFile();
+    std::shared_ptr<const void> source(&file, [](const void *) {});
+    MFERDataCollection collection(ByteView(file), source);
+    MFERDataVisitor count{
+        [](const ATT &att)
+        { return static_cast<uint64_t>(att.getDescriptor().blockLength[0]); },
+        [](const MFERData &data)
+        { return static_cast<uint64_t>(data.getLength()); },
+    };
+    for (auto _ : state)
+    {
+        uint64_t sum = 0;
+        for (const MFERData *data : collection.getMFERDataVector())
+        {
+            sum += visitMFERData(*data, count);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * collection.size()));
+    setThroughput(state, 0, 0);
+}
+BENCHMARK(BM_VisitTags);
+
+// Header fields and channel descriptors, without decoding samples
+static void BM_GetMetadata(benchmark::State &state)
+{
+    const ByteVector &file = getInput(state.range(0));
+    for (auto _ : state)
+    {
+        NihonKohdenData data{ByteView(file)};
+        benchmark::DoNotOptimize(data.getMetadata().channels.size());
+    }
+    setThroughput(state, file.size(), 0);
+}
+BENCHMARK(BM_GetMetadata)->ArgName("scale")->Arg(1)->Arg(16)->Unit(benchmark::kMillisecond);
+
+// Header with the samples of every channel decoded
+static void BM_GetHeader(benchmark::State &state)
+{
+    const ByteVector &file = getInput(state.range(0));
+    uint64_t samples = 0;
+    for (auto _ : state)
+    {
+        NihonKohdenData data{ByteView(file)};
+        samples = getSampleCount(data.getHeader());
+    }
+    setThroughput(state, file.size(), samples);
+}
+BENCHMARK(BM_GetHeader)->ArgName("scale")->Arg(1)->Arg(16)->Unit(benchmark::kMillisecond);
+
+// Anonymization of the patient fields
+static void BM_Anonymize(benchmark::State &state)
+{
+    NihonKohdenData data{ByteView(getTestFile())};
+    for (auto _ : state)
+    {
+        data.anonymize();
+    }
+    setThroughput(state, 0, 0);
+}
+BENCHMARK(BM_Anonymize);
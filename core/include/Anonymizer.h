@@ -0,0 +1,29 @@
+#ifndef ANONYMIZER_H
+#define ANONYMIZER_H
+
+#include "ByteVector.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Bytes of a file to overwrite to anonymize it
+struct FilePatch
+{
+    uint64_t offset;
+    ByteVector bytes;
+};
+
+// Contents of the identifying tags (patient ID, name, age and sex) as anonymized by NihonKohdenData::anonymize,
+// at their offsets in the file. Tags that are already anonymized are left out. The waveform is skipped without
+// being read.
+std::vector<FilePatch> findAnonymizationPatches(ByteView file);
+
+// Anonymizes a file by overwriting only the identifying fields, without reading or rewriting the waveform.
+// The result is the same as NihonKohdenData::anonymize followed by writeToBinary.
+void anonymizeFile(const std::string &fileName);
+
+// Copies the input to the output, using the fast copy of the file system where available, and anonymizes the copy.
+// The input is not modified.
+void anonymizeFile(const std::string &inputFileName, const std::string &outputFileName);
+
+#endif // ANONYMIZER_H
@@ -0,0 +1,83 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+// View of an array allocated in an arena
+template <typename T>
+class ArenaArray
+{
+public:
+    ArenaArray() = default;
+    ArenaArray(T *data, size_t size) : first(data), count(size) {}
+
+    inline T *data() const { return first; }
+    inline size_t size() const { return count; }
+    inline bool empty() const { return count == 0; }
+    inline T *begin() const { return first; }
+    inline T *end() const { return first + count; }
+    inline T &operator[](size_t index) const { return first[index]; }
+
+private:
+    T *first = nullptr;
+    size_t count = 0;
+};
+
+// Monotonic allocator for the elements of a parsed file. Memory is taken from a few large blocks and released
+// all at once when the arena is destroyed. Destructors of objects created in the arena are not run, so they
+// must not own memory or other resources outside of it.
+class Arena
+{
+public:
+    static constexpr size_t blockSize = 1 << 14;    // Size of the first block, allocations larger than a quarter of it get a block of their own
+    static constexpr size_t maxBlockSize = 1 << 20; // Blocks double in size up to this, so large headers take a few blocks
+
+    Arena() = default;
+    ~Arena();
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+    Arena(Arena &&other) noexcept;
+    Arena &operator=(Arena &&other) noexcept;
+
+    void *allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    template <typename T, typename... Args>
+    inline T *create(Args &&...args)
+    {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    inline ArenaArray<T> copyArray(const T *data, size_t size)
+    {
+        T *array = static_cast<T *>(allocate(sizeof(T) * size, alignof(T)));
+        for (size_t i = 0; i < size; i++)
+        {
+            new (array + i) T(data[i]);
+        }
+        return ArenaArray<T>(array, size);
+    }
+
+    inline size_t getBlockCount() const { return blockCount; }
+
+private:
+    struct Block
+    {
+        Block *next;
+    };
+
+    Block *blocks = nullptr;
+    uint8_t *position = nullptr;
+    uint8_t *end = nullptr;
+    size_t blockCount = 0;
+    size_t nextBlockSize = blockSize;
+
+    Block *addBlock(size_t size);
+    void release();
+};
+
+#endif // ARENA_H
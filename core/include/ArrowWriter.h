@@ -0,0 +1,77 @@
+#ifndef ARROWWRITER_H
+#define ARROWWRITER_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Column types supported by ArrowWriter
+enum class ArrowType
+{
+    INT_8,
+    UINT_8,
+    INT_16,
+    UINT_16,
+    INT_32,
+    UINT_32,
+    FLOAT_32,
+    FLOAT_64
+};
+
+uint8_t getArrowTypeSize(ArrowType type); // Size of a single value in bytes
+
+using ArrowMetadata = std::vector<std::pair<std::string, std::string>>;
+
+struct ArrowField
+{
+    std::string name;
+    ArrowType type;
+    bool nullable = false;
+    ArrowMetadata metadata;
+};
+
+// Values of one column in a record batch. The validity bitmap holds one bit per value, least significant bit
+// first, and may be null when every value is valid.
+struct ArrowColumn
+{
+    const uint8_t *values;
+    const uint8_t *validity = nullptr;
+    uint64_t nullCount = 0;
+};
+
+// Writes columns to a file in the Arrow IPC file format. The schema is written on construction and each record
+// batch as soon as it is given, so only one batch needs to be held in memory. The file is complete after close().
+class ArrowWriter
+{
+public:
+    ArrowWriter(const std::string &fileName, const std::vector<ArrowField> &fields, const ArrowMetadata &metadata = {});
+    ~ArrowWriter();
+
+    ArrowWriter(const ArrowWriter &) = delete;
+    ArrowWriter &operator=(const ArrowWriter &) = delete;
+
+    void writeBatch(uint64_t length, const std::vector<ArrowColumn> &columns); // One column per field, each with length values
+    void close();                                                              // Writes the footer
+
+private:
+    struct Block
+    {
+        uint64_t offset;
+        uint32_t metadataLength;
+        uint64_t bodyLength;
+    };
+
+    std::ofstream outputFile;
+    std::vector<ArrowField> fields;
+    ArrowMetadata metadata;
+    std::vector<Block> batches;
+    uint64_t position = 0;
+
+    void write(const void *data, uint64_t size);
+    void writePadding(uint64_t size);
+    Block writeMessage(const std::vector<uint8_t> &message, uint64_t bodyLength);
+};
+
+#endif // ARROWWRITER_H
@@ -0,0 +1,37 @@
+#ifndef BATCHCONVERTER_H
+#define BATCHCONVERTER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class OutputFormat
+{
+    CSV,
+    ARROW
+};
+
+OutputFormat getOutputFormat(const std::string &name); // "csv" or "arrow"
+std::string getOutputExtension(OutputFormat format);
+
+// Outcome of the conversion of one input file
+struct ConversionResult
+{
+    std::string input;
+    std::string output;
+    bool success = false;
+    std::string error; // Message of the error that stopped the conversion, empty on success
+};
+
+constexpr uint64_t defaultBatchMemoryLimit = uint64_t(1) << 30;
+
+// Converts every input file into the output directory, named after the input with the extension of the format.
+// Files are converted on a pool of threads, largest first, so the longest conversions do not end up last.
+// Each worker holds a file as large as its input, so files are only started while the sizes of the files in
+// progress fit within memoryLimit, where 0 is no limit; a file larger than the limit is converted alone. Output is
+// written to a temporary file that is renamed when complete, so a failed file leaves no partial output and is
+// reported in its result without stopping the batch. Results are in the order of the inputs. 0 threads uses every core.
+std::vector<ConversionResult> convertMany(const std::vector<std::string> &inputs, const std::string &outputDirectory, OutputFormat format,
+                                          unsigned int threads = 0, uint64_t memoryLimit = defaultBatchMemoryLimit);
+
+#endif // BATCHCONVERTER_H
@@ -0,0 +1,61 @@
+#ifndef BINARYWRITER_H
+#define BINARYWRITER_H
+
+#include "ByteVector.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Destination of serialized bytes
+class ByteSink
+{
+public:
+    virtual ~ByteSink() = default;
+    virtual void write(const uint8_t *data, size_t size) = 0;
+    inline void write(ByteView bytes) { write(bytes.data(), bytes.size()); }
+    inline void write(uint8_t byte) { write(&byte, 1); }
+};
+
+// Appends to a byte vector
+class ByteVectorSink : public ByteSink
+{
+public:
+    explicit ByteVectorSink(ByteVector &output) : output(output) {}
+    using ByteSink::write;
+    inline void write(const uint8_t *data, size_t size) override { output.insert(output.end(), data, data + size); }
+
+private:
+    ByteVector &output;
+};
+
+// Writes to a file without holding the data in memory. Small writes, such as tags and lengths, are gathered
+// in a buffer, and large writes are written in place together with the buffer in one vectored write.
+// The file is complete after close().
+class BinaryWriter : public ByteSink
+{
+public:
+    static constexpr size_t bufferSize = 1 << 16;
+
+    explicit BinaryWriter(const std::string &fileName);
+    ~BinaryWriter();
+
+    BinaryWriter(const BinaryWriter &) = delete;
+    BinaryWriter &operator=(const BinaryWriter &) = delete;
+
+    using ByteSink::write;
+    void write(const uint8_t *data, size_t size) override;
+    void close();
+
+private:
+    std::vector<uint8_t> buffer;
+#ifdef _WIN32
+    void *fileHandle = nullptr;
+#else
+    int fileDescriptor = -1;
+#endif
+
+    bool isOpen() const;
+    void writeThrough(const uint8_t *data, size_t size); // Writes the buffer followed by the data
+};
+
+#endif // BINARYWRITER_H
@@ -6,6 +6,8 @@
 #include <iomanip>
 #include <cstdint>
 #include <cstring>
+#include <stdexcept>
+#include <type_traits>
 
 enum class ByteOrder
 {
@@ -21,6 +23,70 @@ enum class Encoding
     UTF16LE
 };
 
+// Reads a value of type T from a byte buffer of up to sizeof(T) bytes, zero-extending shorter buffers.
+template <typename T>
+inline T bytesToValue(const uint8_t *bytes, size_t size, ByteOrder byteOrder)
+{
+    static_assert(std::is_integral<T>::value || std::is_floating_point<T>::value, "Return type must be an integral or floating-point type.");
+    if (size > sizeof(T))
+    {
+        throw std::runtime_error("Vector size is larger than the size of the return type.");
+    }
+
+    uint8_t buffer[sizeof(T)] = {};
+    if (byteOrder == ByteOrder::ENDIAN_BIG)
+    {
+        // Systems are typically little-endian; reverse if original data is big-endian.
+        for (size_t i = 0; i < size; ++i)
+        {
+            buffer[i] = bytes[size - 1 - i];
+        }
+    }
+    else
+    {
+        // If the system's byte order matches the data's byte order, copy directly.
+        memcpy(buffer, bytes, size);
+    }
+
+    T value;
+    memcpy(&value, buffer, sizeof(T));
+    return value;
+}
+
+// Reads a full-width value of type T from a byte buffer, which must hold at least sizeof(T) bytes.
+template <typename T>
+inline T loadValue(const uint8_t *bytes, ByteOrder byteOrder)
+{
+    uint8_t buffer[sizeof(T)];
+    if (byteOrder == ByteOrder::ENDIAN_BIG)
+    {
+        for (size_t i = 0; i < sizeof(T); ++i)
+        {
+            buffer[i] = bytes[sizeof(T) - 1 - i];
+        }
+    }
+    else
+    {
+        memcpy(buffer, bytes, sizeof(T));
+    }
+
+    T value;
+    memcpy(&value, buffer, sizeof(T));
+    return value;
+}
+
+// Writes a value of type T to a byte buffer of at least sizeof(T) bytes in the given byte order.
+template <typename T>
+inline void storeValue(uint8_t *bytes, T value, ByteOrder byteOrder)
+{
+    uint8_t buffer[sizeof(T)];
+    memcpy(buffer, &value, sizeof(T));
+    for (size_t i = 0; i < sizeof(T); ++i)
+    {
+        bytes[i] = byteOrder == ByteOrder::ENDIAN_BIG ? buffer[sizeof(T) - 1 - i] : buffer[i];
+    }
+}
+
 // ByteVector class to represent a vector of bytes
 class ByteVector : public std::vector<uint8_t>
 {
@@ -32,27 +98,7 @@ public:
     template <typename T>
     inline T toInt(ByteOrder byteOrder = ByteOrder::ENDIAN_BIG) const
     {
-        static_assert(std::is_integral<T>::value || std::is_floating_point<T>::value, "Return type must be an integral or floating-point type.");
-        if (this->size() > sizeof(T))
-        {
-            throw std::runtime_error("Vector size is larger than the size of the return type.");
-        }
-
-        T value;
-        // If the byte order needs to be reversed for this system, reverse the vector before copying.
-        if (byteOrder == ByteOrder::ENDIAN_BIG)
-        {
-            // Systems are typically little-endian; reverse if original data is big-endian.
-            ByteVector reversedByteVector(this->rbegin(), this->rend());
-            memcpy(&value, reversedByteVector.data(), sizeof(T));
-        }
-        else
-        {
-            // If the system's byte order matches the data's byte order, copy directly.
-            memcpy(&value, this->data(), sizeof(T));
-        }
-
-        return value;
+        return bytesToValue<T>(this->data(), this->size(), byteOrder);
     }
 
     template <typename T>
@@ -83,17 +129,45 @@ public:
     }
 };
 
-class InterpreterGuard
+// Non-owning view of a contiguous range of bytes, such as a slice of a ByteVector or a mapped file.
+// The viewed memory must outlive the view.
+class ByteView
 {
 public:
-    InterpreterGuard() { initializeInterpreter(); }
-    ~InterpreterGuard() { finalizeInterpreter(); }
+    using value_type = uint8_t;
+    using const_iterator = const uint8_t *;
+    using iterator = const_iterator;
+
+    ByteView() = default;
+    ByteView(const uint8_t *data, size_t size) : first(data), count(size) {}
+    ByteView(const ByteVector &byteVector) : first(byteVector.data()), count(byteVector.size()) {}
+
+    inline const uint8_t *data() const { return first; }
+    inline size_t size() const { return count; }
+    inline bool empty() const { return count == 0; }
+    inline const_iterator begin() const { return first; }
+    inline const_iterator end() const { return first + count; }
+    inline uint8_t operator[](size_t index) const { return first[index]; }
+
+    ByteView subview(size_t offset, size_t num) const; // Returns a view of num bytes starting at offset, bounds checked
+
+    std::string stringify() const;
+    std::string toString(Encoding encoding = Encoding::ASCII) const;
+
+    template <typename T>
+    inline T toInt(ByteOrder byteOrder = ByteOrder::ENDIAN_BIG) const
+    {
+        return bytesToValue<T>(first, count, byteOrder);
+    }
+
+    inline operator ByteVector() const { return ByteVector(begin(), end()); } // Copies the viewed bytes
 
 private:
-    void initializeInterpreter() const;
-    void finalizeInterpreter() const;
-    
-    inline static int initializeCount = 0;
+    const uint8_t *first = nullptr;
+    size_t count = 0;
 };
 
+bool operator==(const ByteView &left, const ByteView &right);
+inline bool operator!=(const ByteView &left, const ByteView &right) { return !(left == right); }
+
 #endif
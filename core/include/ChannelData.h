@@ -0,0 +1,59 @@
+#ifndef CHANNELDATA_H
+#define CHANNELDATA_H
+
+#include "ByteVector.h"
+#include <cstdint>
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+
+enum class DataType : uint8_t; // Defined in MFERData.h
+
+// Samples of a single channel, stored in their native data type in little-endian byte order.
+// Conversion to doubles or physical units is done on request.
+class ChannelData
+{
+public:
+    ChannelData() = default;
+    ChannelData(DataType dataType, double scale = 1);
+
+    inline DataType getDataType() const { return dataType; }
+    inline double getScale() const { return scale; } // Physical units per sample value, from SEN
+    inline size_t size() const { return bytes.size() / sampleSize; }
+    inline bool empty() const { return bytes.empty(); }
+    inline ByteView getBytes() const { return ByteView(bytes); }
+
+    // Typed access to the samples, T must be the native type of the data type, such as int16_t for INT_16_S
+    template <typename T>
+    inline const T *samples() const
+    {
+        static_assert(std::is_arithmetic<T>::value, "Sample type must be an arithmetic type.");
+        if (!isSampleType(sizeof(T), std::is_floating_point<T>::value, std::is_signed<T>::value))
+        {
+            throw std::runtime_error("Sample type does not match the channel data type");
+        }
+        return reinterpret_cast<const T *>(bytes.data());
+    }
+
+    double value(size_t index) const;                                  // Sample as a double, missing INT_16_S samples are NaN
+    double physical(size_t index) const;                               // Sample multiplied by the scale
+    void toDoubles(size_t first, size_t count, double *output) const; // Converts a range of samples with the vectorized decoders
+    std::vector<double> toDoubles() const;
+    std::vector<double> toPhysical() const;
+
+    void reserve(size_t count);
+    void append(const uint8_t *source, size_t count, ByteOrder byteOrder); // Appends count samples read in the given byte order
+
+private:
+    DataType dataType{};
+    double scale = 1;
+    uint8_t sampleSize = 2;
+    ByteVector bytes;
+
+    bool isSampleType(size_t size, bool floating, bool isSigned) const;
+};
+
+bool operator==(const ChannelData &left, const ChannelData &right);
+inline bool operator!=(const ChannelData &left, const ChannelData &right) { return !(left == right); }
+
+#endif // CHANNELDATA_H
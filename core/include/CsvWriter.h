@@ -0,0 +1,84 @@
+#ifndef CSVWRITER_H
+#define CSVWRITER_H
+
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Buffered csv output, numbers are formatted with std::to_chars and written in fixed-size chunks.
+// Without a file the text is kept in memory, which is used to format parts of a file on other threads.
+class CsvWriter
+{
+public:
+    static constexpr int defaultPrecision = 6; // Significant digits, matching the default of std::ostream
+    static constexpr size_t defaultBufferSize = 1 << 20;
+
+    CsvWriter(const std::string &fileName, int precision = defaultPrecision, size_t bufferSize = defaultBufferSize);
+    explicit CsvWriter(int precision = defaultPrecision); // Keeps the text in memory, the buffer grows as needed
+    ~CsvWriter();
+
+    CsvWriter(const CsvWriter &) = delete;
+    CsvWriter &operator=(const CsvWriter &) = delete;
+    CsvWriter(CsvWriter &&) = default;
+
+    inline void write(char character)
+    {
+        reserve(1);
+        buffer[used++] = character;
+    }
+
+    inline void write(const char *text, size_t length)
+    {
+        if (length > buffer.size() - used)
+        {
+            writeLarge(text, length);
+            return;
+        }
+        memcpy(buffer.data() + used, text, length);
+        used += length;
+    }
+
+    inline void write(const std::string &text) { write(text.data(), text.size()); }
+    inline void write(const CsvWriter &text) { write(text.data(), text.size()); } // Appends the text of an in-memory writer
+    inline void writeSeparator() { write(", ", 2); }
+    inline void endLine() { write('\n'); }
+
+    // Formats the value like std::ostream does with the configured precision
+    inline void writeNumber(double value)
+    {
+        reserve(maxNumberLength);
+        char *first = buffer.data() + used;
+        std::to_chars_result result = std::to_chars(first, first + maxNumberLength, value, std::chars_format::general, precision);
+        used += result.ptr - first;
+    }
+
+    inline const char *data() const { return buffer.data(); } // Text not yet written to the file
+    inline size_t size() const { return used; }
+    inline void clear() { used = 0; }
+
+    void flush();
+    void close();
+
+private:
+    static constexpr size_t maxNumberLength = 32; // Enough for any double with up to 17 significant digits
+
+    std::ofstream outputFile;
+    std::vector<char> buffer;
+    size_t used = 0;
+    int precision;
+
+    inline void reserve(size_t num)
+    {
+        if (num > buffer.size() - used)
+        {
+            makeRoom(num);
+        }
+    }
+
+    void makeRoom(size_t num);
+    void writeLarge(const char *text, size_t length);
+};
+
+#endif // CSVWRITER_H
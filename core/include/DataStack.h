@@ -3,16 +3,22 @@
 
 #include "ByteVector.h"
 #include <vector>
-#include <deque>
+#include <memory>
 #include <cstdint>
 
+// Bounded read cursor over a contiguous byte buffer.
+// The buffer is not copied, so it must outlive the DataStack and any views popped from it.
+// A shared source may be attached so that parsed data can reference the buffer in place.
 class DataStack
 {
 public:
-    DataStack(const ByteVector dataVector);
+    DataStack(ByteView dataView, std::shared_ptr<const void> source = nullptr);
+    DataStack(ByteVector &&dataVector) = delete; // Would point into a destroyed temporary
 
-    size_t size() const;
-    ByteVector pop_front(uint64_t num = 1);
+    inline const std::shared_ptr<const void> &getSource() const { return source; } // Owner of the buffer, if shared
+
+    inline size_t size() const { return end - position; }
+    ByteView pop_front(uint64_t num = 1);
 
     template <typename T>
     inline T pop_bytes(uint64_t num)
@@ -25,66 +31,64 @@ public:
     template <typename T>
     inline T pop_value(ByteOrder byteOrder = ByteOrder::ENDIAN_BIG)
     {
-        try
-        {
-            ByteVector byteVector = pop_front(sizeof(T));
-            return byteVector.toInt<T>(byteOrder);
-        }
-        catch (const std::runtime_error &e)
-        {
-            throw e;
-        }
+        require(sizeof(T));
+        T value = loadValue<T>(position, byteOrder);
+        position += sizeof(T);
+        return value;
     }
     template <typename T>
     inline std::vector<T> pop_values(uint64_t num, ByteOrder byteOrder = ByteOrder::ENDIAN_BIG)
     {
-        std::vector<T> values;
-        for (int i = 0; i < (int)num; ++i)
+        require(num * sizeof(T));
+        std::vector<T> values(num);
+        for (uint64_t i = 0; i < num; ++i)
         {
-            try
-            {
-                values.push_back(pop_value<T>(byteOrder));
-            }
-            catch (const std::runtime_error &e)
-            {
-                throw e;
-            }
+            values[i] = loadValue<T>(position + i * sizeof(T), byteOrder);
         }
+        position += num * sizeof(T);
         return values;
     }
 
     template <typename T>
     inline double pop_double(ByteOrder byteOrder = ByteOrder::ENDIAN_BIG)
     {
-        try
-        {
-            return static_cast<double>(pop_value<T>(byteOrder));
-        }
-        catch (const std::runtime_error &e)
-        {
-            throw e;
-        }
+        return static_cast<double>(pop_value<T>(byteOrder));
     }
     template <typename T>
     inline std::vector<double> pop_doubles(uint64_t num, ByteOrder byteOrder = ByteOrder::ENDIAN_BIG)
     {
-        std::vector<double> values;
-        for (uint64_t i = 0; i < num; ++i)
+        std::vector<double> values(num);
+        pop_doubles<T>(values.data(), num, byteOrder);
+        return values;
+    }
+    template <typename T>
+    inline void pop_doubles(double *output, uint64_t num, ByteOrder byteOrder = ByteOrder::ENDIAN_BIG)
+    {
+        require(num * sizeof(T));
+        // Branch on byte order once so each loop decodes with a fixed byte order
+        if (byteOrder == ByteOrder::ENDIAN_LITTLE)
         {
-            try
+            for (uint64_t i = 0; i < num; ++i)
             {
-                values.push_back(pop_double<T>(byteOrder));
+                output[i] = static_cast<double>(loadValue<T>(position + i * sizeof(T), ByteOrder::ENDIAN_LITTLE));
             }
-            catch (const std::runtime_error &e)
+        }
+        else
+        {
+            for (uint64_t i = 0; i < num; ++i)
             {
-                throw e;
+                output[i] = static_cast<double>(loadValue<T>(position + i * sizeof(T), ByteOrder::ENDIAN_BIG));
             }
         }
-        return values;
+        position += num * sizeof(T);
     }
 
 private:
-    std::deque<uint8_t> data;
+    const uint8_t *position;
+    const uint8_t *end;
+    std::shared_ptr<const void> source;
+
+    void require(uint64_t num) const; // Throws if fewer than num bytes remain
 };
 
 #endif
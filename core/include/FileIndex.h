@@ -0,0 +1,48 @@
+#ifndef FILEINDEX_H
+#define FILEINDEX_H
+
+#include "NihonKohdenData.h"
+#include "ByteVector.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Identifies the contents of a file. The hash covers every byte outside the waveform payload, so the header
+// is verified without reading the samples, and the size and modification time catch other changes.
+struct FileFingerprint
+{
+    uint64_t size = 0;
+    int64_t modificationTime = 0; // In ticks of the file system clock
+    uint64_t headerHash = 0;      // FNV-1a
+
+    inline bool operator==(const FileFingerprint &other) const
+    {
+        return size == other.size && modificationTime == other.modificationTime && headerHash == other.headerHash;
+    }
+    inline bool operator!=(const FileFingerprint &other) const { return !(*this == other); }
+};
+
+// Layout of a parsed file, stored in a sidecar file next to it so that reopening the file skips parsing
+struct FileIndex
+{
+    static constexpr uint32_t version = 2;
+
+    FileFingerprint fingerprint;
+    std::vector<uint64_t> tagOffsets; // Offset of each top level tag in the file
+    Header header;                    // Header fields and decoded channel descriptors, without patient fields or channel data
+    uint64_t waveformOffset = 0;      // WAV payload within the file
+    uint64_t waveformLength = 0;
+    uint64_t sequenceSize = 0; // Byte stride of the sequences within the payload
+};
+
+std::string getIndexFileName(const std::string &fileName); // The sidecar of a file, "<fileName>.idx"
+
+FileFingerprint getFingerprint(const std::string &fileName, ByteView file, uint64_t waveformOffset, uint64_t waveformLength);
+
+ByteVector serializeFileIndex(const FileIndex &index);
+FileIndex parseFileIndex(ByteView bytes); // Throws for an index that is truncated, corrupt or of another version
+
+// Writes the index to a temporary file that is renamed over the sidecar, so readers never see a partial index
+void writeFileIndex(const std::string &indexFileName, const FileIndex &index);
+
+#endif // FILEINDEX_H
@@ -3,16 +3,28 @@
 
 #include "DataStack.h"
 #include "ByteVector.h"
+#include "ChannelData.h"
+#include "BinaryWriter.h"
+#include "Arena.h"
 
 #include <memory>
 #include <cstdint>
 #include <map>
+#include <array>
+#include <type_traits>
 
+// Element of an MFER file. Elements of a parsed collection are created in its arena, and others, such as
+// elements built for writing, on the heap.
 class MFERData
 {
 public:
     MFERData() = default;
-    MFERData(DataStack *dataStack);
+    MFERData(DataStack *dataStack, Arena *arena = nullptr); // Contents are copied into the arena when given
+    explicit MFERData(const ByteVector &contents);          // For writing, contents must fit a single length byte
+    virtual ~MFERData() = default;
+
+    MFERData(const MFERData &) = delete;
+    MFERData &operator=(const MFERData &) = delete;
 
     inline static uint64_t maxByteLength = 100;
 
@@ -25,21 +37,33 @@ public:
 
     virtual uint8_t getTag() const { return 0x00; };
     const uint64_t &getLength() const { return length; };
-    ByteVector getContents() const;
-    virtual ByteVector toByteVector() const;
+    virtual ByteView getContents() const { return contents; };
+    virtual void write(ByteSink &sink) const; // Writes the tag, length and contents
+    ByteVector toByteVector() const;
 
     virtual void anonymize(){};
 
 protected:
-    uint64_t length;
-    ByteVector contents;
+    uint64_t length = 0;
+    ByteView contents;
+
+    void setContents(ByteView bytes, Arena *arena); // Copies the bytes into the element, the arena or an owned buffer
+    void fillContents(uint8_t value);               // Overwrites the stored contents, for anonymization
 
     inline std::string tagString() const { return ByteVector::fromInt<decltype(getTag())>(getTag()).stringify(); };
     inline std::string lengthString() const { return ByteVector::fromInt<decltype(length)>(length).stringify(); };
     virtual std::string contentsString(std::string left) const;
+
+private:
+    static constexpr size_t localSize = 16; // Attributes and most header fields fit within the element
+
+    uint8_t *storage = nullptr;
+    uint8_t localBytes[localSize];
+    std::unique_ptr<uint8_t[]> ownedBytes; // Long contents of elements outside an arena
 };
 
 std::unique_ptr<MFERData> parseMFERData(DataStack *dataStack);
+MFERData *parseMFERData(DataStack *dataStack, Arena &arena); // The element is owned by the arena
 
 class PRE : public MFERData // Preamble
 {
@@ -198,6 +222,8 @@ enum class DataType : uint8_t // 1 byte
     AHA_8 = 0x09,     // 8 bit AHA compression
 };
 
+uint8_t getDataTypeSize(DataType dataType); // Size of a single sample in bytes
+
 // Lead (Tag of content of MWF_LDN) codes, in order of documentation.
 // Comments describe their meaning and integer value.
 enum class Lead : uint16_t // 2 bytes
@@ -311,12 +337,24 @@ struct LeadInfo
 struct Channel
 {
     LeadInfo leadInfo;
-    DataType dataType;
+    DataType dataType = DataType::INT_16_S; // MFER default when DTP is absent
     uint32_t blockLength;
     float samplingInterval;
     std::string samplingIntervalString;
-    float samplingResolution;
-    std::vector<double> data;
+    float samplingResolution = 1; // When SEN is absent, such as for status channels
+    ChannelData data; // Samples in the native data type, scaled by samplingResolution
+};
+
+// Channel attributes of an ATT, decoded once when it is parsed. The byte order is set by the header, so values
+// stored in it are decoded in both orders, indexed by ByteOrder.
+struct ChannelDescriptor
+{
+    bool hasLead = false;
+    Lead lead[2] = {};
+    DataType dataType = DataType::INT_16_S;
+    uint32_t blockLength[2] = {};
+    const IVL *interval = nullptr;
+    float samplingResolution[2] = {1, 1};
 };
 
 class ATT : public MFERData // A channel, next byte in file specifies number
@@ -324,14 +362,19 @@ class ATT : public MFERData // A channel, next byte in file specifies number
 public:
     static const uint8_t tag = 0x3F;
     uint8_t getTag() const { return tag; }
-    ATT(DataStack *dataStack);
-    std::vector<std::unique_ptr<MFERData>> getAttributes() const;
-    Channel getChannel(ByteOrder byteOrder) const;
-    virtual ByteVector toByteVector() const;
+    ATT(DataStack *dataStack, Arena *arena = nullptr);
+    ATT(uint8_t channelIndex, const std::vector<std::unique_ptr<MFERData>> &attributes); // For writing
+    inline ArenaArray<MFERData *> getAttributes() const { return attributes; }
+    inline const ChannelDescriptor &getDescriptor() const { return descriptor; }
+    Channel getChannel(ByteOrder byteOrder) const; // Built from the cached descriptor
+    void write(ByteSink &sink) const;
 
 private:
     uint8_t channelIndex;
-    std::vector<std::unique_ptr<MFERData>> attributes;
+    ArenaArray<MFERData *> attributes; // Parsed from the contents once, into the arena of the collection
+    std::unique_ptr<Arena> ownedArena;      // Holds the attributes of a channel outside a collection
+    ChannelDescriptor descriptor;
+    void parseAttributes(Arena *arena);
     std::string contentsString(std::string left) const;
 };
 
@@ -340,12 +383,14 @@ class WAV : public MFERData // Waveform data
 public:
     static const uint8_t tag = 0x1E;
     uint8_t getTag() const { return tag; }
-    WAV(DataStack *dataStack);
-    virtual ByteVector toByteVector() const;
+    WAV(DataStack *dataStack, Arena *arena = nullptr); // The payload is referenced in place when the stack has a source
+    void write(ByteSink &sink) const;
+    static ByteVector headerToByteVector(uint32_t length); // Tag and length, for writing a payload of the given length separately
 
 private:
     uint8_t wordLength;
-    ByteVector lengthBytes;
+    uint8_t lengthBytes[sizeof(uint32_t)];
+    std::shared_ptr<const void> source; // Keeps the referenced payload alive outside a collection, which holds the source itself
 };
 
 class END : public MFERData // End of file
@@ -353,8 +398,9 @@ class END : public MFERData // End of file
 public:
     static const uint8_t tag = 0x80;
     uint8_t getTag() const { return tag; }
-    END(DataStack *dataStack);
-    virtual ByteVector toByteVector() const;
+    END() { length = 0x00; }
+    END(DataStack *dataStack, Arena *arena = nullptr);
+    void write(ByteSink &sink) const;
 
 private:
     std::string contentsString(std::string left) const;
@@ -366,9 +412,12 @@ public:
     using MFERData::MFERData;
     static const uint8_t tag = 0x09;
     uint8_t getTag() const { return tag; }
+    Lead getLead(ByteOrder byteOrder) const;
     LeadInfo getLeadInfo(ByteOrder ByteOrder) const;
 };
 
+LeadInfo findLeadInfo(Lead lead); // Named "Unknown" with the code for leads not in LeadMap
+
 class DTP : public MFERData // Data type
 {
 public:
@@ -384,6 +433,7 @@ public:
     using MFERData::MFERData;
     static const uint8_t tag = 0x04;
     uint8_t getTag() const { return tag; }
+    uint32_t getBlockLength(ByteOrder byteOrder) const;
 };
 
 class SEN : public MFERData // Sampling resolution
@@ -395,6 +445,107 @@ public:
     float getSamplingResolution(ByteOrder byteOrder) const;
 };
 
+// Compile-time registry of the element types, by tag. Parsing and visiting dispatch through tables of one entry
+// per tag built from the list, so an element is handled with one indexed call instead of a chain of casts.
+// A tag is added by defining its class, with a tag, a constructor from a DataStack and an optional Arena and,
+// if it is not written as tag, length and contents, an override of write, then listing it in MFERDataTypes.
+template <typename... Types>
+class MFERDataRegistry
+{
+public:
+    static constexpr size_t tagCount = 0x100;
+
+    static constexpr bool hasUniqueTags()
+    {
+        uint8_t tags[] = {Types::tag...};
+        for (size_t i = 0; i < sizeof...(Types); i++)
+        {
+            for (size_t k = i + 1; k < sizeof...(Types); k++)
+            {
+                if (tags[i] == tags[k])
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Parses the element of a tag from the stack, in the arena when given. Returns nullptr for tags not registered.
+    static MFERData *create(uint8_t tag, DataStack *dataStack, Arena *arena)
+    {
+        using Factory = MFERData *(*)(DataStack *, Arena *);
+        static constexpr std::array<Factory, tagCount> factories = []
+        {
+            std::array<Factory, tagCount> table{};
+            ((table[Types::tag] = &createType<Types>), ...);
+            return table;
+        }();
+        Factory factory = factories[tag];
+        return factory == nullptr ? nullptr : factory(dataStack, arena);
+    }
+
+    // Calls the visitor with the element as its registered type, or as Data for tags not registered, such as a
+    // bare MFERData. Data is MFERData or const MFERData, and the visitor must accept it.
+    template <typename Data, typename Visitor>
+    static decltype(auto) visit(Data &data, Visitor &visitor)
+    {
+        static_assert(std::is_same_v<std::remove_const_t<Data>, MFERData>, "Elements are visited through MFERData");
+        using Result = decltype(visitor(data));
+        using Function = Result (*)(Data &, Visitor &);
+        static constexpr std::array<Function, tagCount> functions = []
+        {
+            std::array<Function, tagCount> table{};
+            for (Function &function : table)
+            {
+                function = &visitType<MFERData, Data, Visitor, Result>;
+            }
+            ((table[Types::tag] = &visitType<Types, Data, Visitor, Result>), ...);
+            return table;
+        }();
+        return functions[data.getTag()](data, visitor);
+    }
+
+private:
+    template <typename T>
+    static MFERData *createType(DataStack *dataStack, Arena *arena)
+    {
+        return arena != nullptr ? arena->create<T>(dataStack, arena) : new T(dataStack, arena);
+    }
+
+    template <typename T, typename Data, typename Visitor, typename Result>
+    static Result visitType(Data &data, Visitor &visitor)
+    {
+        using Target = std::conditional_t<std::is_const_v<Data>, const T, T>;
+        return static_cast<Result>(visitor(static_cast<Target &>(data))); // The tag identifies the type
+    }
+};
+
+using MFERDataTypes = MFERDataRegistry<PRE, BLE, TXC, MAN, WFM, TIM, PID, PNM, AGE, SEX, IVL, EVT, SEQ, CHN, NUL,
+                                       ATT, WAV, END, LDN, DTP, BLK, SEN>;
+static_assert(MFERDataTypes::hasUniqueTags(), "Each tag must be registered once");
+
+// Combines lambdas into one visitor, such as MFERDataVisitor{[](const PRE &pre) {}, [](const MFERData &data) {}}
+template <typename... Functions>
+struct MFERDataVisitor : Functions...
+{
+    using Functions::operator()...;
+};
+template <typename... Functions>
+MFERDataVisitor(Functions...) -> MFERDataVisitor<Functions...>;
+
+template <typename Visitor>
+inline decltype(auto) visitMFERData(const MFERData &data, Visitor &&visitor)
+{
+    return MFERDataTypes::visit<const MFERData>(data, visitor);
+}
+
+template <typename Visitor>
+inline decltype(auto) visitMFERData(MFERData &data, Visitor &&visitor)
+{
+    return MFERDataTypes::visit<MFERData>(data, visitor);
+}
+
 // Map of Lead codes to their string representation
 const std::map<Lead, LeadInfo>
     LeadMap = {
@@ -8,25 +8,37 @@
 
 class MFERData;
 
+// Elements of a file, allocated together in one arena and released at once
 class MFERDataCollection
 {
 public:
     MFERDataCollection() = default;
-    MFERDataCollection(ByteVector dataVector);
+    MFERDataCollection(ByteView dataView, std::shared_ptr<const void> source = nullptr); // Large payloads reference a shared source in place
+    MFERDataCollection(ByteView dataView, std::shared_ptr<const void> source, const std::vector<uint64_t> &offsets); // Elements at known offsets, such as from a FileIndex
 
-    inline const std::vector<std::unique_ptr<MFERData>> &getMFERDataVector() const
+    inline const std::vector<MFERData *> &getMFERDataVector() const
     {
         return mferDataVector;
     };
+    inline const std::vector<uint64_t> &getOffsets() const { return offsets; } // Offset of each element within the data
     inline size_t size() const { return mferDataVector.size(); };
     std::string toHexString(uint64_t maxByteLength = 100) const;
+    void write(ByteSink &sink) const; // Writes every tag in order, large contents without copying them
     ByteVector toByteVector() const;
 
+    inline const Arena &getArena() const { return arena; }
+
 private:
-    std::vector<std::unique_ptr<MFERData>> mferDataVector;
+    Arena arena;                         // Owns the elements
+    std::shared_ptr<const void> source; // Keeps payloads referenced in place alive
+    std::vector<MFERData *> mferDataVector;
+    std::vector<uint64_t> offsets;
 };
 
+std::string collectionToHexString(const std::vector<MFERData *> *collection, std::string left);
 std::string collectionToHexString(const std::vector<std::unique_ptr<MFERData>> *collection, std::string left);
-std::vector<std::unique_ptr<MFERData>> parseMFERDataCollection(ByteVector dataVector);
+std::vector<std::unique_ptr<MFERData>> parseMFERDataCollection(ByteView dataView);
+std::vector<std::unique_ptr<MFERData>> parseMFERDataCollection(DataStack *dataStack);
+std::vector<MFERData *> parseMFERDataCollection(DataStack *dataStack, Arena &arena, std::vector<uint64_t> *offsets = nullptr); // Elements are owned by the arena
 
 #endif
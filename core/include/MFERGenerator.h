@@ -0,0 +1,50 @@
+#ifndef MFERGENERATOR_H
+#define MFERGENERATOR_H
+
+#include "MFERData.h"
+#include "ByteVector.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Channel of a generated recording
+struct GeneratorChannel
+{
+    Lead lead = Lead::ECG_II;
+    DataType dataType = DataType::INT_16_S;
+    uint32_t blockLength = 15000;   // Samples per sequence
+    uint8_t samplingInterval = 4;   // Milliseconds per sample
+    int8_t resolutionExponent = -6; // SEN, resolutionBase x10^resolutionExponent units per sample value
+    uint16_t resolutionBase = 2;    // 0 leaves out SEN, as for status channels
+};
+
+// Layout and contents of a generated recording. The defaults match resources/test-file.MWF.
+struct GeneratorOptions
+{
+    std::vector<GeneratorChannel> channels = {
+        {Lead::ECG_II, DataType::INT_16_S, 15000, 4, -6, 2},
+        {Lead::ECG_V5, DataType::INT_16_S, 15000, 4, -6, 2},
+        {Lead::ART, DataType::INT_16_S, 7500, 8, -3, 125},
+        {Lead::PAP, DataType::INT_16_S, 7500, 8, -3, 125},
+        {Lead::CVP, DataType::INT_16_S, 7500, 8, -3, 125},
+        {Lead::PACING_STATUS, DataType::STATUS_16, 15000, 4, 0, 0},
+    };
+    uint16_t sequenceCount = 12;
+    uint8_t samplingInterval = 1; // Milliseconds, the IVL of the header
+    ByteOrder byteOrder = ByteOrder::ENDIAN_LITTLE;
+    uint32_t eventCount = 0;     // NIBP events, spread over the recording
+    double missingDensity = 0;   // Fraction of INT_16_S samples written as -32768 and float samples as NaN
+    uint64_t seed = 0;           // Same seed and options give the same file
+};
+
+std::string getDataTypeName(DataType dataType); // Short name such as "int16s", as used by monk_generate
+DataType getDataTypeFromName(const std::string &name);
+
+// Writes a recording made of the header tags, one ATT per channel and a single WAV. Samples are a
+// pseudo-random waveform per channel, generated one sequence at a time, so the size of the recording is
+// not limited by memory. The waveform must fit within 4 GiB, the largest WAV length this library reads.
+void generateMFER(const GeneratorOptions &options, ByteSink &sink);
+ByteVector generateMFER(const GeneratorOptions &options);
+void generateMFERFile(const std::string &fileName, const GeneratorOptions &options);
+
+#endif // MFERGENERATOR_H
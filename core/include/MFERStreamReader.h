@@ -0,0 +1,68 @@
+#ifndef MFERSTREAMREADER_H
+#define MFERSTREAMREADER_H
+
+#include "MFERData.h"
+#include "ByteVector.h"
+#include <istream>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+// Pull-based reader for MFER data arriving through a stream, pipe or file descriptor.
+// Header elements are returned as they arrive, and the waveform payload is returned in chunks of whole sequences.
+// Only the current item is buffered, so memory use is independent of the file size.
+class MFERStreamReader
+{
+public:
+    enum class ItemType
+    {
+        ELEMENT,  // A complete header element
+        WAVEFORM, // A chunk of the waveform payload
+        END       // End of file tag
+    };
+
+    struct Item
+    {
+        ItemType type;
+        std::unique_ptr<MFERData> element; // Parsed element, for ELEMENT items
+        ByteView waveform;                 // Payload bytes, for WAVEFORM items. Valid until the next call to next()
+        uint64_t offset = 0;               // Offset of the item from the start of the stream
+    };
+
+    explicit MFERStreamReader(std::istream &input, size_t chunkSize = defaultChunkSize);
+    explicit MFERStreamReader(int fileDescriptor, size_t chunkSize = defaultChunkSize);
+
+    bool next(Item &item); // Reads the next item, returns false once the stream is exhausted
+
+    inline ByteOrder getByteOrder() const { return byteOrder; }
+    inline uint16_t getSequenceCount() const { return sequenceCount; }
+    inline const std::vector<Channel> &getChannels() const { return channels; }
+    inline uint64_t getSequenceSize() const { return sequenceSize; }     // Bytes per sequence of the waveform payload
+    inline uint64_t getWaveformLength() const { return waveformLength; } // Total payload length, once the WAV tag is read
+    inline uint64_t getOffset() const { return offset; }                 // Bytes consumed from the stream
+
+    static const size_t defaultChunkSize = 1 << 20;
+
+private:
+    std::istream *input = nullptr;
+    int fileDescriptor = -1;
+    size_t chunkSize;
+
+    ByteVector buffer;
+    uint64_t offset = 0;
+    bool finished = false;
+
+    ByteOrder byteOrder = ByteOrder::ENDIAN_LITTLE;
+    uint16_t sequenceCount = 0;
+    std::vector<Channel> channels;
+    uint64_t sequenceSize = 0;
+    uint64_t waveformLength = 0;
+    uint64_t waveformRemaining = 0;
+
+    size_t readSome(uint8_t *destination, size_t num);
+    void read(size_t num);           // Appends exactly num bytes to the buffer, throws at end of stream
+    void readWaveformChunk(Item &item);
+    void track(const MFERData &data); // Records fields needed to split the waveform payload
+};
+
+#endif // MFERSTREAMREADER_H
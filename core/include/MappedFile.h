@@ -0,0 +1,43 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include "ByteVector.h"
+#include <string>
+#include <memory>
+#include <cstdint>
+
+// Read-only memory mapping of a file, so data is read in place rather than copied into memory.
+// Pages are only loaded when touched. The file must not be truncated while it is mapped.
+class MappedFile
+{
+public:
+    enum class Access
+    {
+        SEQUENTIAL, // Read once front to back, with aggressive read-ahead and pages dropped behind the reader
+        NORMAL      // Read in windows at any position, with the default read-ahead and pages kept cached
+    };
+
+    explicit MappedFile(const std::string &fileName, Access access = Access::SEQUENTIAL);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    static std::shared_ptr<const MappedFile> open(const std::string &fileName, Access access = Access::SEQUENTIAL);
+
+    inline const uint8_t *data() const { return address; }
+    inline size_t size() const { return length; }
+    inline ByteView view() const { return ByteView(address, length); }
+
+private:
+    const uint8_t *address = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    void *fileHandle = nullptr;
+    void *mappingHandle = nullptr;
+#endif
+
+    void unmap();
+};
+
+#endif // MAPPEDFILE_H
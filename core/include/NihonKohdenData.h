@@ -4,6 +4,10 @@
 #include "MFERDataCollection.h"
 #include "MFERData.h"
 #include "FileManager.h"
+#include "MappedFile.h"
+#include "CsvWriter.h"
+#include "ArrowWriter.h"
+#include "Resampler.h"
 #include "ByteVector.h"
 #include <variant>
 #include <cstdint>
@@ -35,28 +39,118 @@ struct Interval
     double end = 0;
 };
 
+// Position of a sample of a channel within the waveform
+struct SamplePosition
+{
+    uint32_t sequence; // May be past the last sequence for times after the end of the recording
+    uint32_t sample;   // Index of the sample within the channel block of the sequence
+};
+
+struct FileFingerprint;
+
 class NihonKohdenData
 {
 public:
-    NihonKohdenData(ByteVector dataVector);
-    NihonKohdenData(const std::string &fileName) : NihonKohdenData(FileManager::readBinaryFile(fileName)){};
+    NihonKohdenData(ByteView dataView);
+    NihonKohdenData(const std::string &fileName, bool useIndex = false); // Maps the file, which must stay unmodified while the object exists
+
+    // With useIndex, the header is read from the sidecar index of the file (see FileIndex.h) when it matches the file,
+    // and the tags are only parsed when needed, by anonymize, printHexData or writeToBinary. A missing, stale or
+    // corrupt index is rebuilt after parsing the file.
+    inline bool isIndexed() const { return indexed; } // Opened from a valid index, without parsing
+    inline bool hasSourceFile() const { return fingerprint != nullptr; }
+    FileFingerprint getFingerprint() const; // Of the source file when it was opened, see FileIndex.h. Throws for data not read from a file
 
-    inline Header getHeader() const { return collectDataFields(collection.getMFERDataVector()); }
+    const Header &getHeader() const;                                // Header including the data of the selected channels, cached until the data is modified
+    inline const Header &getMetadata() const { return header; }     // Header fields and channel descriptors, without channel data
+    const ChannelData &getChannelData(size_t index) const;         // Decodes the channel on first request (not thread-safe)
+    inline ByteView getWaveform() const { return waveform; }       // Raw WAV payload, valid for the lifetime of the object
+    SamplePosition getSamplePosition(size_t index, double time) const; // Sample of the channel at index taken at or before time, in seconds
+    uint64_t getSampleCount(size_t index) const;                      // Samples of the channel at index over every sequence
+
+    // Decodes count samples of the channel at index, starting at startSample, into output as doubles with missing
+    // values as NaN. Only the bytes of the requested samples are read from the waveform and nothing is cached, so
+    // windows of long recordings are read in time proportional to their length, from any number of threads.
+    void readSamples(size_t index, uint64_t startSample, uint64_t count, double *output) const;
     void anonymize();
     void setChannelSelection(int index, bool active);
+    void setChannelSelection(Lead lead, bool active); // Selects every channel of the lead
+    inline const std::vector<bool> &getChannelSelection() const { return channelSelection; }
     void setIntervalSelection(double start = 0, double end = 0);
+    inline void setVerbose(bool enabled) { verbose = enabled; } // Progress messages of the writers, on by default
+
+    // Aligns the selected channels on rows every samplingInterval seconds in writeToCsv, writeToArrow and readResampled,
+    // instead of rows at the rate of the fastest channel with empty cells for slower channels. 0 turns resampling off.
+    void setResampling(double samplingInterval, ResampleMode mode = ResampleMode::LINEAR);
+    inline double getResamplingInterval() const { return resamplingInterval; }
+    uint64_t getResampledRowCount() const; // Rows within the interval selection
+    // Writes count rows from firstRow of the interval selection, each the time followed by the selected channels, as in the csv output
+    void readResampled(uint64_t firstRow, uint64_t count, double *output) const;
 
     void printHexData() const;
     void printHeader() const;
-    void writeToBinary(const std::string &fileName) const;
-    void writeToCsv(const std::string &fileName) const;
+    void writeToBinary(const std::string &fileName) const; // Streams the tags to the file, which may be the source file
+    void writeToCsv(const std::string &fileName, int precision = CsvWriter::defaultPrecision, unsigned int threads = 1) const; // Precision is the number of significant digits, 0 threads uses every core
+    void writeToArrow(const std::string &fileName, uint32_t sequencesPerBatch = 10) const; // Arrow IPC file with one record batch per group of sequences
 
 private:
-    MFERDataCollection collection;
-    std::vector<bool> channelSelection = std::vector<bool>(17, true);
+    std::string sourceFileName; // Mapped file the data is read from, if any
+    std::shared_ptr<const MappedFile> file;
+    std::shared_ptr<const FileFingerprint> fingerprint; // Taken once, as it reads the modification time and hashes the header
+    mutable MFERDataCollection collection; // Parsed on first use when the header is read from an index
+    mutable bool parsed = false;
+    std::vector<uint64_t> tagOffsets; // From the index, so the collection is parsed without scanning the file
+    bool indexed = false;
+    Header header;     // Index of header fields and channel descriptors, channel data is decoded on request
+    ByteView waveform; // WAV payload, owned by the collection
+    mutable Header cache; // Copy of the header that holds the data of every decoded channel
+    mutable std::vector<bool> decodedChannels;
+    uint64_t sequenceSize = 0;            // Bytes per sequence, each sequence holds one block of every channel
+    std::vector<uint64_t> channelOffsets; // Offset of each channel block within a sequence
+    std::vector<bool> channelSelection; // One entry per channel, unselected channels are skipped when decoding
     Interval intervalSelection; // Interval selection in seconds
+    bool verbose = true;
+    double resamplingInterval = 0;     // Seconds between rows of the outputs, 0 when not resampling
+    ResampleMode resamplingMode = ResampleMode::LINEAR;
+    std::vector<Resampler> resamplers; // One per channel while resampling
+
+    struct OutputLayout
+    {
+        std::vector<size_t> channels;        // Indices of the selected channels
+        std::vector<int> channelIntervals;   // Rows per sample of each selected channel
+        uint64_t largestBlockLength = 0;     // Rows per sequence
+        double samplingInterval;             // Seconds per row
+        uint64_t firstRow;                   // Rows within the interval selection
+        uint64_t lastRow;
+        uint32_t firstSequence;              // Sequences holding those rows
+        uint32_t lastSequence;
+    };
+
+    void parseCollection() const;
+    bool readIndex();  // Returns false when the index is missing, stale or corrupt
+    void readPatientFields();
+    void writeIndex() const;
+    void buildIndex();
+    void indexHeader();
+    void indexSequences();
+    template <typename Visitor>
+    void forEachSampleBlock(size_t index, uint64_t first, uint64_t count, Visitor &&visit) const;
+    void decodeChannelRange(size_t index, uint64_t first, uint64_t count, double *output) const; // Decodes samples straight from the waveform
+    void copyChannelRange(size_t index, uint64_t first, uint64_t count, ChannelData &output) const; // Appends samples in their native type
+    struct ResampledLayout
+    {
+        std::vector<size_t> channels; // Indices of the selected channels
+        uint64_t firstRow;            // Rows within the interval selection, at firstRow * resamplingInterval seconds
+        uint64_t lastRow;
+    };
 
-    Header collectDataFields(const std::vector<std::unique_ptr<MFERData>> &mferDataVector) const;
+    OutputLayout getOutputLayout() const;
+    ResampledLayout getResampledLayout() const;
+    void resampleRows(const ResampledLayout &layout, uint64_t firstRow, uint64_t count, std::vector<std::vector<double>> &columns) const;
+    void writeResampledCsv(CsvWriter &file, int precision, unsigned int threads) const;
+    void writeResampledArrow(const std::string &fileName, uint32_t sequencesPerBatch) const;
+    std::pair<uint64_t, uint64_t> getSampleRange(const OutputLayout &layout, size_t channel, uint32_t firstSequence, uint32_t lastSequence) const;
+    Header collectDataFields(const std::vector<MFERData *> &mferDataVector);
 };
 
 #endif
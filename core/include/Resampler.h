@@ -0,0 +1,55 @@
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum class ResampleMode
+{
+    HOLD,     // Last sample at or before the time
+    LINEAR,   // Linear interpolation between the samples around the time
+    POLYPHASE // Windowed sinc filter bank, low-passed below the target Nyquist rate when downsampling
+};
+
+ResampleMode getResampleMode(const std::string &name); // "hold", "linear" or "polyphase"
+std::string getResampleModeName(ResampleMode mode);
+
+// Resamples a channel to outputs at n * targetInterval. Intervals are taken in whole microseconds, so the position
+// of each output within the source is an exact fraction and outputs do not drift over long recordings. Outputs are
+// computed in independent ranges from the source samples returned by getSourceRange, which lets callers decode a
+// channel piece by piece. Samples before the first and after the last repeat them, and missing (NaN) samples make
+// the outputs they contribute to missing.
+class Resampler
+{
+public:
+    static constexpr int zeroCrossings = 8;            // Of the sinc on each side of the polyphase filter
+    static constexpr uint32_t maxPhases = 1024;        // Filters of the polyphase bank, the phase is rounded when there are more
+    static constexpr uint64_t maxFilterSize = 1 << 20; // Coefficients of the bank, fewer phases are used for long filters
+
+    Resampler(double sourceInterval, double targetInterval, ResampleMode mode, uint64_t sampleCount);
+
+    inline ResampleMode getMode() const { return mode; }
+    inline int getTapCount() const { return tapCount; }
+    inline uint32_t getPhaseCount() const { return phaseCount; }
+    uint64_t getOutputCount() const; // Outputs before the end of the source
+
+    std::pair<uint64_t, uint64_t> getSourceRange(uint64_t firstOutput, uint64_t count) const; // Samples [first, last) used by the outputs
+
+    // Writes count outputs from firstOutput, where source holds the samples of getSourceRange(firstOutput, count)
+    void resample(const double *source, uint64_t firstOutput, uint64_t count, double *output) const;
+
+private:
+    ResampleMode mode;
+    uint64_t up;   // Output n is at n * down / up source samples
+    uint64_t down;
+    uint64_t sampleCount;
+    int tapCount = 0;
+    uint32_t phaseCount = 0;
+    std::vector<double> filters; // tapCount coefficients per phase
+
+    std::pair<uint64_t, uint32_t> getFilterPosition(uint64_t output) const; // Sample the filter is centred after, and its phase
+};
+
+#endif // RESAMPLER_H
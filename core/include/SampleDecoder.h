@@ -0,0 +1,26 @@
+#ifndef SAMPLEDECODER_H
+#define SAMPLEDECODER_H
+
+#include "MFERData.h"
+#include "ByteVector.h"
+#include <cstdint>
+#include <cstddef>
+
+// Instruction set used to decode waveform samples
+enum class DecodeKernel
+{
+    SCALAR,
+    SSE2,
+    AVX2
+};
+
+DecodeKernel getDecodeKernel();                      // Fastest kernel supported by this CPU, selected at runtime
+bool isDecodeKernelSupported(DecodeKernel kernel);   // Whether the kernel can run on this CPU
+std::string decodeKernelName(DecodeKernel kernel);
+
+// Decodes count samples of the given data type into doubles, converting from the given byte order.
+// INT_16_S samples of -32768 mark missing data and are decoded as NaN.
+void decodeSamples(const uint8_t *source, size_t count, DataType dataType, ByteOrder byteOrder, double *output);
+void decodeSamples(const uint8_t *source, size_t count, DataType dataType, ByteOrder byteOrder, double *output, DecodeKernel kernel);
+
+#endif // SAMPLEDECODER_H
@@ -0,0 +1,61 @@
+#ifndef SIDECARFILE_H
+#define SIDECARFILE_H
+
+#include "ByteVector.h"
+#include "DataStack.h"
+#include <cstdint>
+#include <string>
+
+// Encoding of the files stored next to a recording, such as the file index and the summary pyramid: a magic
+// string and a version, values stored little-endian with strings and lists prefixed by their length, and a
+// trailing FNV-1a checksum of everything before it.
+
+uint64_t hashBytes(ByteView bytes, uint64_t hash = 0xCBF29CE484222325ull); // FNV-1a, continuing from hash
+
+class SidecarWriter
+{
+public:
+    SidecarWriter(const ByteVector &magic, uint32_t version);
+
+    template <typename T>
+    void value(T value)
+    {
+        size_t size = bytes.size();
+        bytes.resize(size + sizeof(T));
+        storeValue<T>(bytes.data() + size, value, ByteOrder::ENDIAN_LITTLE);
+    }
+
+    void string(const std::string &text);
+    ByteVector finish(); // Appends the checksum and returns the contents
+
+private:
+    ByteVector bytes;
+};
+
+class SidecarReader
+{
+public:
+    // Checks the magic, checksum and version of the contents, throwing with the name of the format when they do not match
+    SidecarReader(ByteView bytes, const ByteVector &magic, uint32_t version, const std::string &name);
+
+    template <typename T>
+    T value()
+    {
+        return dataStack.pop_value<T>(ByteOrder::ENDIAN_LITTLE);
+    }
+
+    std::string string();
+    uint32_t count(size_t minimumSize); // Length of a list, checked against the bytes left so corrupt lengths do not allocate
+    void finish();                      // Throws if anything is left after the last value
+
+    inline size_t size() const { return dataStack.size(); }
+
+private:
+    std::string name;
+    DataStack dataStack;
+};
+
+// Writes to a temporary file that is renamed over fileName, so readers never see a partial file
+void writeSidecarFile(const std::string &fileName, ByteView bytes);
+
+#endif // SIDECARFILE_H
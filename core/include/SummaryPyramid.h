@@ -0,0 +1,83 @@
+#ifndef SUMMARYPYRAMID_H
+#define SUMMARYPYRAMID_H
+
+#include "NihonKohdenData.h"
+#include "FileIndex.h"
+#include "ByteVector.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Summary of a run of consecutive samples of a channel. Missing samples are left out, so a bin of missing
+// samples only has a count of 0 and NaN values.
+struct SummaryBin
+{
+    float min;
+    float max;
+    float mean;
+    uint32_t count; // Samples that are not missing
+};
+
+struct SummaryOptions
+{
+    uint32_t baseBinLength = 16; // Samples per bin of the first level
+    uint32_t levelFactor = 4;    // Bins of a level merged into each bin of the next
+};
+
+// Bins of a channel covering a requested time range, at the level chosen for a display width
+struct SummaryRange
+{
+    uint32_t level = 0;     // 0 for raw samples, each as its own bin
+    uint64_t binLength = 1; // Samples per bin, the last bin of a channel may hold fewer
+    uint64_t firstBin = 0;  // Index of the first bin within the level
+    double binDuration = 0; // Seconds per bin
+    double start = 0;       // Time of the first sample of the first bin, in seconds
+    std::vector<SummaryBin> bins;
+};
+
+// Min, max and mean of every channel over bins of increasing length, levelFactor times longer at each level,
+// up to a single bin per channel. The levels are built in a single pass over the waveform, one sequence at a
+// time, and take about 1.3 bytes per sample with the default options. A pyramid of a file holds its fingerprint,
+// so it is only used with data of that file as it was summarized.
+class SummaryPyramid
+{
+public:
+    static constexpr uint32_t version = 2;
+
+    SummaryPyramid() = default;
+    explicit SummaryPyramid(const NihonKohdenData &data, const SummaryOptions &options = SummaryOptions());
+
+    inline const SummaryOptions &getOptions() const { return options; }
+    inline size_t getChannelCount() const { return channels.size(); }
+    size_t getLevelCount(size_t channel) const;                          // Stored levels, from 1 to the level with a single bin
+    uint64_t getBinLength(size_t level) const;                           // Samples per bin of the level, 1 for level 0
+    const std::vector<SummaryBin> &getLevel(size_t channel, size_t level) const;
+    bool matches(const NihonKohdenData &data) const;                     // Summarizes data, of the same file unchanged since
+
+    // Bins covering the samples of the channel from start to end in seconds, at the coarsest level with at least
+    // one bin per pixel, so between pixels and levelFactor times pixels bins are returned for ranges longer than
+    // the pixels. Raw samples are only read, from data, when even the first level is coarser than a pixel; without
+    // data the first level is returned instead. Throws for data that the pyramid does not match.
+    SummaryRange query(size_t channel, double start, double end, uint32_t pixels, const NihonKohdenData *data = nullptr) const;
+
+    ByteVector serialize() const;
+    static SummaryPyramid parse(ByteView bytes); // Throws for a pyramid that is truncated, corrupt or of another version
+    void write(const std::string &fileName) const;
+    static SummaryPyramid read(const std::string &fileName, const NihonKohdenData &data); // Throws unless the pyramid matches data
+
+private:
+    struct ChannelSummary
+    {
+        double samplingInterval = 0; // Seconds per sample
+        uint64_t sampleCount = 0;
+        std::vector<std::vector<SummaryBin>> levels; // Level 1 first
+    };
+
+    SummaryOptions options;
+    FileFingerprint fingerprint; // Of the file summarized, empty for data not read from a file
+    std::vector<ChannelSummary> channels;
+
+    const ChannelSummary &getChannel(size_t channel) const;
+};
+
+#endif // SUMMARYPYRAMID_H
@@ -0,0 +1,83 @@
+#include "Anonymizer.h"
+#include "MFERData.h"
+#include "MappedFile.h"
+#include <filesystem>
+#include <fstream>
+
+std::vector<FilePatch> findAnonymizationPatches(ByteView file)
+{
+    // A source makes WAV reference the payload in place, so the waveform pages are not read
+    std::shared_ptr<const void> source(file.data(), [](const void *) {});
+    DataStack dataStack(file, source);
+    std::vector<FilePatch> patches;
+    while (dataStack.size() > 0)
+    {
+        std::unique_ptr<MFERData> data = parseMFERData(&dataStack);
+        uint64_t end = file.size() - dataStack.size(); // Contents are the last bytes of a tag
+        uint8_t tag = data->getTag();
+        if (tag == PID::tag || tag == PNM::tag || tag == AGE::tag || tag == SEX::tag)
+        {
+            ByteVector contents = data->getContents();
+            uint64_t length = data->getLength();
+            data->anonymize();
+            if (data->getContents() != ByteView(contents))
+            {
+                if (data->getContents().size() != length) // Written over the old contents, so any other length would shift the file
+                {
+                    throw std::runtime_error("Anonymized contents differ in length from the original.");
+                }
+                patches.push_back({end - length, data->getContents()});
+            }
+        }
+        if (tag == END::tag)
+        {
+            break;
+        }
+    }
+    return patches;
+}
+
+void anonymizeFile(const std::string &fileName)
+{
+    std::vector<FilePatch> patches;
+    {
+        std::shared_ptr<const MappedFile> file = MappedFile::open(fileName);
+        patches = findAnonymizationPatches(file->view());
+    } // Unmapped before writing
+    if (patches.empty())
+    {
+        return;
+    }
+
+    std::fstream file(fileName, std::ios::in | std::ios::out | std::ios::binary); // Opened without truncating
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Error opening file.");
+    }
+    for (const FilePatch &patch : patches)
+    {
+        file.seekp(static_cast<std::streamoff>(patch.offset));
+        file.write(reinterpret_cast<const char *>(patch.bytes.data()), static_cast<std::streamsize>(patch.bytes.size()));
+    }
+    file.close();
+    if (file.fail())
+    {
+        throw std::runtime_error("Error writing file.");
+    }
+}
+
+void anonymizeFile(const std::string &inputFileName, const std::string &outputFileName)
+{
+    std::error_code error;
+    if (std::filesystem::equivalent(inputFileName, outputFileName, error))
+    {
+        anonymizeFile(outputFileName);
+        return;
+    }
+    std::filesystem::copy_file(inputFileName, outputFileName, std::filesystem::copy_options::overwrite_existing, error);
+    if (error)
+    {
+        throw std::runtime_error("Error copying file: " + error.message());
+    }
+    anonymizeFile(outputFileName);
+}
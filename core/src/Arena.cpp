@@ -0,0 +1,93 @@
+#include "Arena.h"
+#include <algorithm>
+
+namespace
+{
+    constexpr size_t headerSize = (sizeof(void *) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+    inline uint8_t *alignUp(uint8_t *pointer, size_t alignment)
+    {
+        uintptr_t address = reinterpret_cast<uintptr_t>(pointer);
+        return pointer + ((alignment - address % alignment) % alignment);
+    }
+}
+
+Arena::~Arena()
+{
+    release();
+}
+
+Arena::Arena(Arena &&other) noexcept
+    : blocks(other.blocks), position(other.position), end(other.end), blockCount(other.blockCount), nextBlockSize(other.nextBlockSize)
+{
+    other.blocks = nullptr;
+    other.position = nullptr;
+    other.end = nullptr;
+    other.blockCount = 0;
+    other.nextBlockSize = blockSize;
+}
+
+Arena &Arena::operator=(Arena &&other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        std::swap(blocks, other.blocks);
+        std::swap(position, other.position);
+        std::swap(end, other.end);
+        std::swap(blockCount, other.blockCount);
+        std::swap(nextBlockSize, other.nextBlockSize);
+    }
+    return *this;
+}
+
+void *Arena::allocate(size_t size, size_t alignment)
+{
+    if (position != nullptr)
+    {
+        size_t padding = alignUp(position, alignment) - position;
+        if (padding + size <= static_cast<size_t>(end - position))
+        {
+            position += padding + size;
+            return position - size;
+        }
+    }
+
+    if (size + alignment > blockSize / 4)
+    {
+        // Large contents, such as a copied waveform, get a block of their own, and the space left in the
+        // current block is still used for the following allocations
+        Block *block = addBlock(size + alignment);
+        return alignUp(reinterpret_cast<uint8_t *>(block) + headerSize, alignment);
+    }
+
+    size_t newBlockSize = nextBlockSize;
+    Block *block = addBlock(newBlockSize);
+    nextBlockSize = std::min(nextBlockSize * 2, maxBlockSize);
+    uint8_t *aligned = alignUp(reinterpret_cast<uint8_t *>(block) + headerSize, alignment);
+    position = aligned + size;
+    end = reinterpret_cast<uint8_t *>(block) + headerSize + newBlockSize;
+    return aligned;
+}
+
+Arena::Block *Arena::addBlock(size_t size)
+{
+    Block *block = static_cast<Block *>(::operator new(headerSize + size));
+    block->next = blocks;
+    blocks = block;
+    blockCount++;
+    return block;
+}
+
+void Arena::release()
+{
+    while (blocks != nullptr)
+    {
+        Block *next = blocks->next;
+        ::operator delete(blocks);
+        blocks = next;
+    }
+    position = end = nullptr;
+    blockCount = 0;
+    nextBlockSize = blockSize;
+}
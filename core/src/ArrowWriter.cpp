@@ -0,0 +1,411 @@
+#include "ArrowWriter.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    // Minimal flatbuffer builder for the Arrow metadata. Flatbuffers are built back to front, so bytes are
+    // prepended to a reversed buffer and objects are referred to by their distance from the end.
+    class FlatBufferBuilder
+    {
+    public:
+        inline uint32_t size() const { return static_cast<uint32_t>(bytes.size()); }
+
+        uint32_t createString(const std::string &string)
+        {
+            align(string.size() + 1, 4);
+            bytes.push_back(0); // Null terminator
+            prepend(string.data(), string.size());
+            prependRaw<uint32_t>(static_cast<uint32_t>(string.size()));
+            return size();
+        }
+
+        // Vector of structs, written in the given order
+        uint32_t createStructVector(const void *data, size_t count, size_t elementSize)
+        {
+            align(count * elementSize, 8);
+            prepend(data, count * elementSize);
+            prependRaw<uint32_t>(static_cast<uint32_t>(count));
+            return size();
+        }
+
+        uint32_t createOffsetVector(const std::vector<uint32_t> &offsets)
+        {
+            align(offsets.size() * 4, 4);
+            for (size_t i = offsets.size(); i > 0; i--)
+            {
+                prependOffset(offsets[i - 1]);
+            }
+            prependRaw<uint32_t>(static_cast<uint32_t>(offsets.size()));
+            return size();
+        }
+
+        void startTable()
+        {
+            fieldLocations.clear();
+            tableStart = size();
+        }
+
+        template <typename T>
+        void addScalar(uint16_t field, T value)
+        {
+            align(sizeof(T), sizeof(T));
+            prependRaw<T>(value);
+            fieldLocations.emplace_back(field, size());
+        }
+
+        void addOffset(uint16_t field, uint32_t target)
+        {
+            prependOffset(target);
+            fieldLocations.emplace_back(field, size());
+        }
+
+        uint32_t endTable()
+        {
+            align(4, 4);
+            prependRaw<int32_t>(0); // Offset to the vtable, patched below
+            uint32_t table = size();
+
+            uint16_t fieldCount = 0;
+            for (const auto &location : fieldLocations)
+            {
+                fieldCount = std::max<uint16_t>(fieldCount, location.first + 1);
+            }
+            std::vector<uint16_t> vtable(fieldCount, 0);
+            for (const auto &location : fieldLocations)
+            {
+                vtable[location.first] = static_cast<uint16_t>(table - location.second);
+            }
+            for (size_t i = vtable.size(); i > 0; i--)
+            {
+                prependRaw<uint16_t>(vtable[i - 1]);
+            }
+            prependRaw<uint16_t>(static_cast<uint16_t>(table - tableStart));
+            prependRaw<uint16_t>(static_cast<uint16_t>(4 + 2 * fieldCount));
+
+            int32_t vtableOffset = static_cast<int32_t>(size() - table); // The vtable precedes the table
+            for (size_t i = 0; i < sizeof(vtableOffset); i++)
+            {
+                bytes[table - 1 - i] = reinterpret_cast<const uint8_t *>(&vtableOffset)[i];
+            }
+            return table;
+        }
+
+        std::vector<uint8_t> finish(uint32_t root)
+        {
+            align(4, 8);
+            prependOffset(root);
+            return std::vector<uint8_t>(bytes.rbegin(), bytes.rend());
+        }
+
+    private:
+        std::vector<uint8_t> bytes; // Reversed
+        std::vector<std::pair<uint16_t, uint32_t>> fieldLocations;
+        uint32_t tableStart = 0;
+
+        // Pads so that the next size bytes end on an alignment boundary
+        void align(size_t size, size_t alignment)
+        {
+            while ((bytes.size() + size) % alignment != 0)
+            {
+                bytes.push_back(0);
+            }
+        }
+
+        void prepend(const void *data, size_t size)
+        {
+            const uint8_t *source = static_cast<const uint8_t *>(data);
+            for (size_t i = size; i > 0; i--)
+            {
+                bytes.push_back(source[i - 1]);
+            }
+        }
+
+        template <typename T>
+        void prependRaw(T value) // Values are little-endian, like the host
+        {
+            prepend(&value, sizeof(T));
+        }
+
+        void prependOffset(uint32_t target)
+        {
+            align(4, 4);
+            prependRaw<uint32_t>(size() + 4 - target);
+        }
+    };
+
+    // Arrow format constants, from Schema.fbs, Message.fbs and File.fbs
+    const int16_t metadataVersion = 4; // V5
+    const uint8_t typeInt = 2;
+    const uint8_t typeFloatingPoint = 3;
+    const uint8_t headerSchema = 1;
+    const uint8_t headerRecordBatch = 3;
+    const char magic[] = "ARROW1";
+
+    struct FieldNode
+    {
+        int64_t length;
+        int64_t nullCount;
+    };
+
+    struct Buffer
+    {
+        int64_t offset;
+        int64_t length;
+    };
+
+    struct FooterBlock
+    {
+        int64_t offset;
+        int32_t metadataLength;
+        int32_t padding;
+        int64_t bodyLength;
+    };
+
+    uint64_t padded(uint64_t size)
+    {
+        return (size + 7) / 8 * 8;
+    }
+
+    uint32_t buildMetadata(FlatBufferBuilder &builder, const ArrowMetadata &metadata)
+    {
+        std::vector<uint32_t> pairs;
+        for (const auto &pair : metadata)
+        {
+            uint32_t key = builder.createString(pair.first);
+            uint32_t value = builder.createString(pair.second);
+            builder.startTable();
+            builder.addOffset(0, key);
+            builder.addOffset(1, value);
+            pairs.push_back(builder.endTable());
+        }
+        return builder.createOffsetVector(pairs);
+    }
+
+    uint32_t buildSchema(FlatBufferBuilder &builder, const std::vector<ArrowField> &fields, const ArrowMetadata &metadata)
+    {
+        std::vector<uint32_t> fieldTables;
+        for (const auto &field : fields)
+        {
+            uint32_t name = builder.createString(field.name);
+            uint32_t children = builder.createOffsetVector({});
+            uint32_t fieldMetadata = buildMetadata(builder, field.metadata);
+
+            bool floating = field.type == ArrowType::FLOAT_32 || field.type == ArrowType::FLOAT_64;
+            builder.startTable();
+            if (floating)
+            {
+                builder.addScalar<int16_t>(0, field.type == ArrowType::FLOAT_32 ? 1 : 2); // SINGLE or DOUBLE precision
+            }
+            else
+            {
+                bool isSigned = field.type == ArrowType::INT_8 || field.type == ArrowType::INT_16 || field.type == ArrowType::INT_32;
+                builder.addScalar<int32_t>(0, getArrowTypeSize(field.type) * 8);
+                builder.addScalar<uint8_t>(1, isSigned);
+            }
+            uint32_t type = builder.endTable();
+
+            builder.startTable();
+            builder.addOffset(0, name);
+            builder.addOffset(3, type);
+            builder.addOffset(5, children);
+            builder.addOffset(6, fieldMetadata);
+            builder.addScalar<uint8_t>(1, field.nullable);
+            builder.addScalar<uint8_t>(2, floating ? typeFloatingPoint : typeInt);
+            fieldTables.push_back(builder.endTable());
+        }
+        uint32_t fieldVector = builder.createOffsetVector(fieldTables);
+        uint32_t schemaMetadata = buildMetadata(builder, metadata);
+
+        builder.startTable();
+        builder.addOffset(1, fieldVector);
+        builder.addOffset(2, schemaMetadata);
+        builder.addScalar<int16_t>(0, 0); // Little endian
+        return builder.endTable();
+    }
+
+    std::vector<uint8_t> buildMessage(FlatBufferBuilder &builder, uint8_t headerType, uint32_t header, uint64_t bodyLength)
+    {
+        builder.startTable();
+        builder.addScalar<int64_t>(3, bodyLength);
+        builder.addOffset(2, header);
+        builder.addScalar<int16_t>(0, metadataVersion);
+        builder.addScalar<uint8_t>(1, headerType);
+        return builder.finish(builder.endTable());
+    }
+}
+
+uint8_t getArrowTypeSize(ArrowType type)
+{
+    switch (type)
+    {
+    case ArrowType::INT_8:
+    case ArrowType::UINT_8:
+        return 1;
+    case ArrowType::INT_16:
+    case ArrowType::UINT_16:
+        return 2;
+    case ArrowType::INT_32:
+    case ArrowType::UINT_32:
+    case ArrowType::FLOAT_32:
+        return 4;
+    case ArrowType::FLOAT_64:
+        return 8;
+    default:
+        throw std::runtime_error("Invalid arrow type");
+    }
+}
+
+ArrowWriter::ArrowWriter(const std::string &fileName, const std::vector<ArrowField> &fields, const ArrowMetadata &metadata)
+    : fields(fields), metadata(metadata)
+{
+    outputFile.open(fileName, std::ios::binary | std::ios::trunc);
+    if (!outputFile.is_open())
+    {
+        throw std::runtime_error("Error opening file.");
+    }
+
+    write(magic, 6);
+    writePadding(2);
+
+    FlatBufferBuilder builder;
+    uint32_t schema = buildSchema(builder, fields, metadata);
+    writeMessage(buildMessage(builder, headerSchema, schema, 0), 0);
+}
+
+ArrowWriter::~ArrowWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (const std::exception &)
+    {
+        // Errors are only reported by an explicit close
+    }
+}
+
+void ArrowWriter::writeBatch(uint64_t length, const std::vector<ArrowColumn> &columns)
+{
+    if (!outputFile.is_open())
+    {
+        throw std::runtime_error("Arrow file is closed");
+    }
+    if (columns.size() != fields.size())
+    {
+        throw std::runtime_error("Column count does not match the schema");
+    }
+
+    // Each column has a validity buffer, empty when every value is valid, and a values buffer
+    std::vector<FieldNode> nodes;
+    std::vector<Buffer> buffers;
+    uint64_t bodyLength = 0;
+    for (size_t i = 0; i < columns.size(); i++)
+    {
+        if (columns[i].nullCount > 0 && !fields[i].nullable)
+        {
+            throw std::runtime_error("Null values in a field that is not nullable: " + fields[i].name);
+        }
+        uint64_t validityLength = columns[i].nullCount > 0 ? (length + 7) / 8 : 0;
+        uint64_t valuesLength = length * getArrowTypeSize(fields[i].type);
+        nodes.push_back({static_cast<int64_t>(length), static_cast<int64_t>(columns[i].nullCount)});
+        buffers.push_back({static_cast<int64_t>(bodyLength), static_cast<int64_t>(validityLength)});
+        bodyLength += padded(validityLength);
+        buffers.push_back({static_cast<int64_t>(bodyLength), static_cast<int64_t>(valuesLength)});
+        bodyLength += padded(valuesLength);
+    }
+
+    FlatBufferBuilder builder;
+    uint32_t nodeVector = builder.createStructVector(nodes.data(), nodes.size(), sizeof(FieldNode));
+    uint32_t bufferVector = builder.createStructVector(buffers.data(), buffers.size(), sizeof(Buffer));
+    builder.startTable();
+    builder.addScalar<int64_t>(0, length);
+    builder.addOffset(1, nodeVector);
+    builder.addOffset(2, bufferVector);
+    uint32_t recordBatch = builder.endTable();
+
+    Block block = writeMessage(buildMessage(builder, headerRecordBatch, recordBatch, bodyLength), bodyLength);
+    for (size_t i = 0; i < columns.size(); i++)
+    {
+        uint64_t validityLength = buffers[2 * i].length;
+        uint64_t valuesLength = buffers[2 * i + 1].length;
+        write(columns[i].validity, validityLength);
+        writePadding(padded(validityLength) - validityLength);
+        write(columns[i].values, valuesLength);
+        writePadding(padded(valuesLength) - valuesLength);
+    }
+    batches.push_back(block);
+}
+
+void ArrowWriter::close()
+{
+    if (!outputFile.is_open())
+    {
+        return;
+    }
+
+    uint32_t endOfStream[] = {0xFFFFFFFF, 0};
+    write(endOfStream, sizeof(endOfStream));
+
+    std::vector<FooterBlock> blocks;
+    for (const auto &batch : batches)
+    {
+        blocks.push_back({static_cast<int64_t>(batch.offset), static_cast<int32_t>(batch.metadataLength), 0, static_cast<int64_t>(batch.bodyLength)});
+    }
+    FlatBufferBuilder builder;
+    uint32_t schema = buildSchema(builder, fields, metadata);
+    uint32_t dictionaries = builder.createStructVector(nullptr, 0, sizeof(FooterBlock));
+    uint32_t recordBatches = builder.createStructVector(blocks.data(), blocks.size(), sizeof(FooterBlock));
+    builder.startTable();
+    builder.addOffset(1, schema);
+    builder.addOffset(2, dictionaries);
+    builder.addOffset(3, recordBatches);
+    builder.addScalar<int16_t>(0, metadataVersion);
+    std::vector<uint8_t> footer = builder.finish(builder.endTable());
+
+    uint32_t footerLength = static_cast<uint32_t>(footer.size());
+    write(footer.data(), footer.size());
+    write(&footerLength, sizeof(footerLength));
+    write(magic, 6);
+
+    outputFile.close();
+    if (outputFile.fail())
+    {
+        throw std::runtime_error("Error writing file.");
+    }
+}
+
+void ArrowWriter::write(const void *data, uint64_t size)
+{
+    if (size == 0)
+    {
+        return;
+    }
+    if (!outputFile.write(static_cast<const char *>(data), size))
+    {
+        throw std::runtime_error("Error writing file.");
+    }
+    position += size;
+}
+
+void ArrowWriter::writePadding(uint64_t size)
+{
+    const char zeros[8] = {};
+    write(zeros, size);
+}
+
+// Writes an encapsulated message: continuation marker, metadata length, and the metadata padded to 8 bytes.
+// The body is written by the caller.
+ArrowWriter::Block ArrowWriter::writeMessage(const std::vector<uint8_t> &message, uint64_t bodyLength)
+{
+    Block block{position, 0, bodyLength};
+    uint32_t continuation = 0xFFFFFFFF;
+    uint32_t metadataLength = static_cast<uint32_t>(padded(message.size()));
+    write(&continuation, sizeof(continuation));
+    write(&metadataLength, sizeof(metadataLength));
+    write(message.data(), message.size());
+    writePadding(metadataLength - message.size());
+    block.metadataLength = 8 + metadataLength;
+    return block;
+}
@@ -0,0 +1,157 @@
+#include "BatchConverter.h"
+#include "NihonKohdenData.h"
+#include <algorithm>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+OutputFormat getOutputFormat(const std::string &name)
+{
+    if (name == "csv")
+    {
+        return OutputFormat::CSV;
+    }
+    if (name == "arrow")
+    {
+        return OutputFormat::ARROW;
+    }
+    throw std::runtime_error("Unknown output format: " + name);
+}
+
+std::string getOutputExtension(OutputFormat format)
+{
+    switch (format)
+    {
+    case OutputFormat::CSV:
+        return ".csv";
+    case OutputFormat::ARROW:
+        return ".arrow";
+    default:
+        throw std::runtime_error("Unknown output format");
+    }
+}
+
+// Each file is converted on a single thread, the batch is parallel across files
+static void convertFile(const std::string &input, const std::string &output, OutputFormat format)
+{
+    NihonKohdenData data(input);
+    data.setVerbose(false);
+    switch (format)
+    {
+    case OutputFormat::CSV:
+        data.writeToCsv(output);
+        break;
+    case OutputFormat::ARROW:
+        data.writeToArrow(output);
+        break;
+    }
+}
+
+std::vector<ConversionResult> convertMany(const std::vector<std::string> &inputs, const std::string &outputDirectory, OutputFormat format,
+                                          unsigned int threads, uint64_t memoryLimit)
+{
+    if (threads == 0)
+    {
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    std::error_code directoryError;
+    fs::create_directories(outputDirectory, directoryError);
+    if (directoryError)
+    {
+        throw std::runtime_error("Error creating output directory: " + outputDirectory);
+    }
+
+    // Name the outputs and order the files by size, largest first
+    std::vector<ConversionResult> results(inputs.size());
+    std::vector<uint64_t> sizes(inputs.size(), 0);
+    std::vector<size_t> order;
+    std::set<std::string> outputs;
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        fs::path output = fs::path(outputDirectory) / fs::path(inputs[i]).stem();
+        output += getOutputExtension(format);
+        results[i].input = inputs[i];
+        results[i].output = output.string();
+        if (!outputs.insert(results[i].output).second)
+        {
+            results[i].error = "Output file name is used by another input";
+            continue;
+        }
+        std::error_code sizeError;
+        uintmax_t size = fs::file_size(inputs[i], sizeError);
+        sizes[i] = sizeError ? 0 : size; // Unreadable files fail quickly when opened
+        order.push_back(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t left, size_t right)
+                     { return sizes[left] > sizes[right]; });
+
+    size_t next = 0;    // Next file of order to convert
+    uint64_t inUse = 0; // Sum of the sizes of the files in progress
+    unsigned int running = 0;
+    std::mutex mutex;
+    std::condition_variable changed;
+
+    auto work = [&]()
+    {
+        while (true)
+        {
+            size_t i;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&]
+                             { return next >= order.size() || running == 0 || memoryLimit == 0 || inUse + sizes[order[next]] <= memoryLimit; });
+                if (next >= order.size())
+                {
+                    return;
+                }
+                i = order[next++];
+                inUse += sizes[i];
+                running++;
+            }
+
+            std::string partial = results[i].output + ".part";
+            try
+            {
+                convertFile(results[i].input, partial, format);
+                fs::rename(partial, results[i].output);
+                results[i].success = true;
+            }
+            catch (const std::exception &e)
+            {
+                results[i].error = e.what();
+            }
+            catch (...)
+            {
+                results[i].error = "Unknown error";
+            }
+            if (!results[i].success)
+            {
+                std::error_code removeError;
+                fs::remove(partial, removeError);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                inUse -= sizes[i];
+                running--;
+            }
+            changed.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned int i = 0; i < std::min<size_t>(threads, order.size()); i++)
+    {
+        workers.emplace_back(work);
+    }
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+    return results;
+}
@@ -0,0 +1,196 @@
+#include "BinaryWriter.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const size_t maxWriteSize = size_t(1) << 30; // Largest single write, within the limits of every platform
+}
+
+void BinaryWriter::write(const uint8_t *data, size_t size)
+{
+    if (!isOpen())
+    {
+        throw std::runtime_error("File is closed.");
+    }
+    if (size <= bufferSize - buffer.size())
+    {
+        buffer.insert(buffer.end(), data, data + size);
+    }
+    else if (size < bufferSize)
+    {
+        writeThrough(nullptr, 0);
+        buffer.insert(buffer.end(), data, data + size);
+    }
+    else
+    {
+        writeThrough(data, size); // Large contents, such as the waveform, are not copied
+    }
+}
+
+#ifdef _WIN32
+
+bool BinaryWriter::isOpen() const
+{
+    return fileHandle != nullptr;
+}
+
+BinaryWriter::BinaryWriter(const std::string &fileName)
+{
+    fileHandle = CreateFileA(fileName.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        fileHandle = nullptr;
+        throw std::runtime_error("Error opening file.");
+    }
+    buffer.reserve(bufferSize);
+}
+
+static void writeHandle(void *fileHandle, const uint8_t *data, size_t size)
+{
+    while (size > 0)
+    {
+        DWORD written = 0;
+        if (!WriteFile(fileHandle, data, static_cast<DWORD>(std::min(size, maxWriteSize)), &written, nullptr))
+        {
+            throw std::runtime_error("Error writing file.");
+        }
+        data += written;
+        size -= written;
+    }
+}
+
+void BinaryWriter::writeThrough(const uint8_t *data, size_t size)
+{
+    writeHandle(fileHandle, buffer.data(), buffer.size());
+    buffer.clear();
+    writeHandle(fileHandle, data, size);
+}
+
+void BinaryWriter::close()
+{
+    if (!isOpen())
+    {
+        return;
+    }
+    try
+    {
+        writeThrough(nullptr, 0);
+    }
+    catch (...)
+    {
+        CloseHandle(fileHandle);
+        fileHandle = nullptr;
+        throw;
+    }
+    bool closed = CloseHandle(fileHandle);
+    fileHandle = nullptr;
+    if (!closed)
+    {
+        throw std::runtime_error("Error writing file.");
+    }
+}
+
+#else
+
+bool BinaryWriter::isOpen() const
+{
+    return fileDescriptor >= 0;
+}
+
+BinaryWriter::BinaryWriter(const std::string &fileName)
+{
+    fileDescriptor = ::open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (fileDescriptor < 0)
+    {
+        throw std::runtime_error("Error opening file.");
+    }
+    buffer.reserve(bufferSize);
+}
+
+void BinaryWriter::writeThrough(const uint8_t *data, size_t size)
+{
+    const uint8_t *pointers[2] = {buffer.data(), data};
+    size_t remaining[2] = {buffer.size(), size};
+    while (remaining[0] + remaining[1] > 0)
+    {
+        struct iovec pieces[2];
+        int count = 0;
+        for (int i = 0; i < 2; i++)
+        {
+            if (remaining[i] > 0)
+            {
+                pieces[count++] = {const_cast<uint8_t *>(pointers[i]), std::min(remaining[i], maxWriteSize)};
+            }
+        }
+        ssize_t written = ::writev(fileDescriptor, pieces, count);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw std::runtime_error("Error writing file.");
+        }
+        size_t advance = static_cast<size_t>(written); // Pieces are written in order, so a partial write ends in the first unfinished piece
+        for (int i = 0; i < 2; i++)
+        {
+            size_t step = std::min(advance, remaining[i]);
+            pointers[i] += step;
+            remaining[i] -= step;
+            advance -= step;
+        }
+    }
+    buffer.clear();
+}
+
+void BinaryWriter::close()
+{
+    if (!isOpen())
+    {
+        return;
+    }
+    try
+    {
+        writeThrough(nullptr, 0);
+    }
+    catch (...)
+    {
+        ::close(fileDescriptor);
+        fileDescriptor = -1;
+        throw;
+    }
+    int result = ::close(fileDescriptor);
+    fileDescriptor = -1;
+    if (result != 0)
+    {
+        throw std::runtime_error("Error writing file.");
+    }
+}
+
+#endif
+
+BinaryWriter::~BinaryWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (...)
+    {
+        // Errors are only reported by an explicit close()
+    }
+}
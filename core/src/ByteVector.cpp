@@ -1,13 +1,34 @@
 #include "ByteVector.h"
-#include <pybind11/embed.h>
 #include <cstdint>
 #include <vector>
 #include <sstream>
 #include <iostream>
 
-namespace py = pybind11;
-
 std::string ByteVector::stringify() const
+{
+    return ByteView(*this).stringify();
+}
+
+std::string ByteVector::toString(Encoding encoding) const
+{
+    return ByteView(*this).toString(encoding);
+}
+
+ByteView ByteView::subview(size_t offset, size_t num) const
+{
+    if (offset > count || num > count - offset)
+    {
+        throw std::runtime_error("Error while reading data, number out of range.");
+    }
+    return ByteView(first + offset, num);
+}
+
+bool operator==(const ByteView &left, const ByteView &right)
+{
+    return left.size() == right.size() && (left.empty() || memcmp(left.data(), right.data(), left.size()) == 0);
+}
+
+std::string ByteView::stringify() const
 {
     std::ostringstream stream;
     for (auto val : *this)
@@ -15,60 +36,134 @@ std::string ByteVector::stringify() const
         stream << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << (int)val << " ";
     }
     std::string string = stream.str();
-    string.pop_back();
+    if (!string.empty())
+    {
+        string.pop_back(); // Remove trailing space
+    }
     return string;
 }
 
-std::string ByteVector::toString(Encoding encoding) const
+// Appends a code point to a string as UTF-8
+static void appendUtf8(std::string &string, uint32_t codePoint)
 {
-    InterpreterGuard guard; // Initialize embedded python interpreter and finalize when out of scope
-
-    py::gil_scoped_acquire acquire; // Ensure GIL is held
+    if (codePoint < 0x80)
+    {
+        string += static_cast<char>(codePoint);
+    }
+    else if (codePoint < 0x800)
+    {
+        string += static_cast<char>(0xC0 | (codePoint >> 6));
+        string += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+    else if (codePoint < 0x10000)
+    {
+        string += static_cast<char>(0xE0 | (codePoint >> 12));
+        string += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        string += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+    else
+    {
+        string += static_cast<char>(0xF0 | (codePoint >> 18));
+        string += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        string += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        string += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
 
-    try
+// Checks that the bytes are well-formed UTF-8, rejecting overlong forms, surrogates and code points above U+10FFFF
+static bool isValidUtf8(const uint8_t *bytes, size_t size)
+{
+    size_t i = 0;
+    while (i < size)
     {
-        std::string str(this->begin(), this->end());
-        if (encoding == Encoding::ASCII || encoding == Encoding::UTF8)
+        uint8_t byte = bytes[i];
+        if (byte < 0x80)
+        {
+            i++;
+            continue;
+        }
+
+        size_t length;
+        uint8_t lower = 0x80, upper = 0xBF; // Allowed range of the second byte
+        if (byte >= 0xC2 && byte <= 0xDF)
+        {
+            length = 2;
+        }
+        else if (byte >= 0xE0 && byte <= 0xEF)
         {
-            return py::bytes(str).attr("decode")(py::str("utf-8")).cast<std::string>();
+            length = 3;
+            lower = byte == 0xE0 ? 0xA0 : 0x80;
+            upper = byte == 0xED ? 0x9F : 0xBF;
         }
-        else if (encoding == Encoding::UTF16LE)
+        else if (byte >= 0xF0 && byte <= 0xF4)
         {
-            return py::bytes(str).attr("decode")(py::str("utf-16-le")).cast<std::string>();
+            length = 4;
+            lower = byte == 0xF0 ? 0x90 : 0x80;
+            upper = byte == 0xF4 ? 0x8F : 0xBF;
         }
         else
         {
-            throw std::runtime_error("Unsupported encoding.");
+            return false;
         }
-    }
-    catch (const py::error_already_set &e)
-    {
-        throw std::runtime_error("Python error occurred in ByteVector::toString");
-    }
-}
 
-void InterpreterGuard::initializeInterpreter() const
-{
-    if (initializeCount++ == 0) // If first initialization
-    {
-        if (Py_IsInitialized() == 0) // If Python interpreter is not initialized
+        if (size - i < length || bytes[i + 1] < lower || bytes[i + 1] > upper)
         {
-            py::initialize_interpreter(); // Initialize Python interpreter
+            return false;
         }
-        else // If Python interpreter is already initialized
+        for (size_t j = 2; j < length; j++)
         {
-            initializeCount++; // Increment the count to avoid re-initialization
+            if ((bytes[i + j] & 0xC0) != 0x80)
+            {
+                return false;
+            }
         }
+        i += length;
     }
+    return true;
 }
 
-void InterpreterGuard::finalizeInterpreter() const
+std::string ByteView::toString(Encoding encoding) const
 {
-    if (--initializeCount == 0) // If last finalization
+    if (encoding == Encoding::ASCII || encoding == Encoding::UTF8)
+    {
+        // ASCII is a subset of UTF-8, so valid text is passed through unchanged
+        if (!isValidUtf8(first, count))
+        {
+            throw std::runtime_error("Error decoding string, invalid UTF-8.");
+        }
+        return std::string(begin(), end());
+    }
+    else if (encoding == Encoding::UTF16LE)
     {
-        if (Py_IsInitialized() != 0) // If Python interpreter is initialized
+        if (count % 2 != 0)
+        {
+            throw std::runtime_error("Error decoding string, truncated UTF-16LE.");
+        }
+        std::string string;
+        string.reserve(count);
+        for (size_t i = 0; i < count; i += 2)
         {
-            py::finalize_interpreter(); // Finalize Python interpreter
+            uint32_t unit = first[i] | (first[i + 1] << 8);
+            if (unit >= 0xD800 && unit <= 0xDBFF) // High surrogate, must be followed by a low surrogate
+            {
+                uint32_t low = i + 3 < count ? (first[i + 2] | (first[i + 3] << 8)) : 0;
+                if (low < 0xDC00 || low > 0xDFFF)
+                {
+                    throw std::runtime_error("Error decoding string, invalid UTF-16LE.");
+                }
+                unit = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+                i += 2;
+            }
+            else if (unit >= 0xDC00 && unit <= 0xDFFF)
+            {
+                throw std::runtime_error("Error decoding string, invalid UTF-16LE.");
+            }
+            appendUtf8(string, unit);
         }
+        return string;
+    }
+    else
+    {
+        throw std::runtime_error("Unsupported encoding.");
     }
 }
@@ -0,0 +1,96 @@
+#include "ChannelData.h"
+#include "MFERData.h"
+#include "SampleDecoder.h"
+#include <algorithm>
+
+ChannelData::ChannelData(DataType dataType, double scale) : dataType(dataType), scale(scale), sampleSize(getDataTypeSize(dataType))
+{
+}
+
+bool ChannelData::isSampleType(size_t size, bool floating, bool isSigned) const
+{
+    if (size != sampleSize)
+    {
+        return false;
+    }
+    switch (dataType)
+    {
+    case DataType::FLOAT_32:
+    case DataType::FLOAT_64:
+        return floating;
+    case DataType::INT_16_S:
+    case DataType::INT_32_S:
+    case DataType::INT_8_S:
+        return !floating && isSigned;
+    default:
+        return !floating && !isSigned;
+    }
+}
+
+double ChannelData::value(size_t index) const
+{
+    if (index >= size())
+    {
+        throw std::runtime_error("Sample index out of range");
+    }
+    double output;
+    decodeSamples(bytes.data() + index * sampleSize, 1, dataType, ByteOrder::ENDIAN_LITTLE, &output);
+    return output;
+}
+
+double ChannelData::physical(size_t index) const
+{
+    return value(index) * scale;
+}
+
+void ChannelData::toDoubles(size_t first, size_t count, double *output) const
+{
+    if (first > size() || count > size() - first)
+    {
+        throw std::runtime_error("Sample index out of range");
+    }
+    decodeSamples(bytes.data() + first * sampleSize, count, dataType, ByteOrder::ENDIAN_LITTLE, output);
+}
+
+std::vector<double> ChannelData::toDoubles() const
+{
+    std::vector<double> output(size());
+    toDoubles(0, output.size(), output.data());
+    return output;
+}
+
+std::vector<double> ChannelData::toPhysical() const
+{
+    std::vector<double> output = toDoubles();
+    for (double &value : output)
+    {
+        value *= scale;
+    }
+    return output;
+}
+
+void ChannelData::reserve(size_t count)
+{
+    bytes.reserve(count * sampleSize);
+}
+
+void ChannelData::append(const uint8_t *source, size_t count, ByteOrder byteOrder)
+{
+    size_t first = bytes.size();
+    bytes.resize(first + count * sampleSize);
+    uint8_t *output = bytes.data() + first;
+    if (byteOrder == ByteOrder::ENDIAN_LITTLE || sampleSize == 1)
+    {
+        memcpy(output, source, count * sampleSize);
+        return;
+    }
+    for (size_t i = 0; i < count; i++) // Reverse the bytes of each sample
+    {
+        std::reverse_copy(source + i * sampleSize, source + (i + 1) * sampleSize, output + i * sampleSize);
+    }
+}
+
+bool operator==(const ChannelData &left, const ChannelData &right)
+{
+    return left.getDataType() == right.getDataType() && left.getScale() == right.getScale() && left.getBytes() == right.getBytes();
+}
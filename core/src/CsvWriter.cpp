@@ -0,0 +1,100 @@
+#include "CsvWriter.h"
+#include <algorithm>
+#include <stdexcept>
+
+CsvWriter::CsvWriter(const std::string &fileName, int precision, size_t bufferSize) : precision(precision)
+{
+    if (precision < 1 || precision > 17)
+    {
+        throw std::runtime_error("Precision must be between 1 and 17");
+    }
+
+    outputFile.open(fileName, std::ios::out | std::ios::trunc);
+    if (!outputFile.is_open())
+    {
+        throw std::runtime_error("Error opening file.");
+    }
+    buffer.resize(std::max(bufferSize, maxNumberLength));
+}
+
+CsvWriter::CsvWriter(int precision) : precision(precision)
+{
+    if (precision < 1 || precision > 17)
+    {
+        throw std::runtime_error("Precision must be between 1 and 17");
+    }
+    buffer.resize(defaultBufferSize / 16);
+}
+
+CsvWriter::~CsvWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (const std::exception &)
+    {
+        // Errors are only reported by an explicit close
+    }
+}
+
+// Writes out the buffer, or grows it when there is no file, so that num more bytes fit
+void CsvWriter::makeRoom(size_t num)
+{
+    if (outputFile.is_open())
+    {
+        flush();
+    }
+    if (num > buffer.size() - used)
+    {
+        buffer.resize(std::max(buffer.size() * 2, used + num));
+    }
+}
+
+void CsvWriter::writeLarge(const char *text, size_t length)
+{
+    if (!outputFile.is_open())
+    {
+        makeRoom(length);
+        memcpy(buffer.data() + used, text, length);
+        used += length;
+        return;
+    }
+
+    flush();
+    if (length <= buffer.size())
+    {
+        memcpy(buffer.data(), text, length);
+        used = length;
+    }
+    else if (!outputFile.write(text, length))
+    {
+        throw std::runtime_error("Error writing file.");
+    }
+}
+
+void CsvWriter::flush()
+{
+    if (used == 0 || !outputFile.is_open())
+    {
+        return;
+    }
+    if (!outputFile.write(buffer.data(), used))
+    {
+        throw std::runtime_error("Error writing file.");
+    }
+    used = 0;
+}
+
+void CsvWriter::close()
+{
+    if (outputFile.is_open())
+    {
+        flush();
+        outputFile.close();
+        if (outputFile.fail())
+        {
+            throw std::runtime_error("Error writing file.");
+        }
+    }
+}
@@ -1,52 +1,41 @@
 #include "DataStack.h"
 #include "ByteVector.h"
 
-DataStack::DataStack(const ByteVector dataVector)
+DataStack::DataStack(ByteView dataView, std::shared_ptr<const void> source)
+    : position(dataView.data()), end(dataView.data() + dataView.size()), source(std::move(source))
 {
-    try
-    {
-        data.insert(data.end(), dataVector.begin(), dataVector.end()); // Transfer data to deque
-    }
-    catch (const std::exception &e)
-    {
-        throw std::runtime_error("Error while initializing DataStack: " + std::string(e.what()));
-    }
 }
 
-ByteVector DataStack::pop_front(uint64_t num)
+void DataStack::require(uint64_t num) const
 {
-    if (data.size() < num)
+    if (size() < num)
     {
         throw std::runtime_error("Error while reading data, number out of range.");
     }
-    ByteVector byteVector;
-    for (uint64_t i = 0; i < num; ++i)
-    {
-        byteVector.push_back(data.front());
-        data.pop_front();
-    }
-    return byteVector;
+}
+
+ByteView DataStack::pop_front(uint64_t num)
+{
+    require(num);
+    ByteView byteView(position, num);
+    position += num;
+    return byteView;
 }
 
 uint8_t DataStack::pop_byte()
 {
-    if (data.empty())
+    if (position == end)
     {
         throw std::runtime_error("Error while reading data, stack is empty.");
     }
-    return pop_front().toInt<uint8_t>();
+    return *position++;
 }
 
 uint8_t DataStack::read_byte() const
 {
-    if (data.empty())
+    if (position == end)
     {
         throw std::runtime_error("Error while reading data, stack is empty.");
     }
-    return data.front();
-}
-
-size_t DataStack::size() const
-{
-    return data.size();
+    return *position;
 }
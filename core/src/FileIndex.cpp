@@ -0,0 +1,148 @@
+#include "FileIndex.h"
+#include "SidecarFile.h"
+#include <filesystem>
+
+namespace
+{
+    const ByteVector magic = {'M', 'O', 'N', 'K', 'I', 'D', 'X', 0x00};
+
+    // Patient fields are not stored, so no copy of them is left beside a file anonymized in place
+    void writeHeader(SidecarWriter &writer, const Header &header)
+    {
+        writer.string(header.preamble);
+        writer.value<uint8_t>(static_cast<uint8_t>(header.byteOrder));
+        writer.string(header.modelInfo);
+        writer.value<uint8_t>(header.waveformType);
+        writer.string(header.measurementTimeISO);
+        writer.value<float>(header.samplingInterval);
+        writer.string(header.samplingIntervalString);
+        writer.value<uint32_t>(static_cast<uint32_t>(header.events.size()));
+        for (const NIBPEvent &event : header.events)
+        {
+            writer.value<uint16_t>(event.eventCode);
+            writer.value<uint32_t>(event.startTime);
+            writer.value<uint32_t>(event.duration);
+            writer.string(event.information);
+        }
+        writer.value<uint16_t>(header.sequenceCount);
+        writer.value<uint8_t>(header.channelCount);
+        writer.value<uint32_t>(static_cast<uint32_t>(header.channels.size()));
+        for (const Channel &channel : header.channels)
+        {
+            writer.value<uint16_t>(static_cast<uint16_t>(channel.leadInfo.lead));
+            writer.string(channel.leadInfo.attribute);
+            writer.string(channel.leadInfo.samplingResolution);
+            writer.value<uint8_t>(channel.leadInfo.unitCode);
+            writer.value<uint8_t>(static_cast<uint8_t>(channel.dataType));
+            writer.value<uint32_t>(channel.blockLength);
+            writer.value<float>(channel.samplingInterval);
+            writer.string(channel.samplingIntervalString);
+            writer.value<float>(channel.samplingResolution);
+        }
+    }
+
+    Header readHeader(SidecarReader &reader)
+    {
+        Header header;
+        header.preamble = reader.string();
+        header.byteOrder = static_cast<ByteOrder>(reader.value<uint8_t>());
+        header.modelInfo = reader.string();
+        header.waveformType = reader.value<uint8_t>();
+        header.measurementTimeISO = reader.string();
+        header.samplingInterval = reader.value<float>();
+        header.samplingIntervalString = reader.string();
+        uint32_t eventCount = reader.count(14);
+        for (uint32_t i = 0; i < eventCount; i++)
+        {
+            NIBPEvent event;
+            event.eventCode = reader.value<uint16_t>();
+            event.startTime = reader.value<uint32_t>();
+            event.duration = reader.value<uint32_t>();
+            event.information = reader.string();
+            header.events.push_back(event);
+        }
+        header.sequenceCount = reader.value<uint16_t>();
+        header.channelCount = reader.value<uint8_t>();
+        uint32_t channelCount = reader.count(28);
+        for (uint32_t i = 0; i < channelCount; i++)
+        {
+            Channel channel;
+            channel.leadInfo.lead = static_cast<Lead>(reader.value<uint16_t>());
+            channel.leadInfo.attribute = reader.string();
+            channel.leadInfo.samplingResolution = reader.string();
+            channel.leadInfo.unitCode = reader.value<uint8_t>();
+            channel.dataType = static_cast<DataType>(reader.value<uint8_t>());
+            getDataTypeSize(channel.dataType); // Throws for unknown data types
+            channel.blockLength = reader.value<uint32_t>();
+            channel.samplingInterval = reader.value<float>();
+            channel.samplingIntervalString = reader.string();
+            channel.samplingResolution = reader.value<float>();
+            header.channels.push_back(channel);
+        }
+        return header;
+    }
+}
+
+std::string getIndexFileName(const std::string &fileName)
+{
+    return fileName + ".idx";
+}
+
+FileFingerprint getFingerprint(const std::string &fileName, ByteView file, uint64_t waveformOffset, uint64_t waveformLength)
+{
+    FileFingerprint fingerprint;
+    fingerprint.size = file.size();
+    fingerprint.modificationTime = static_cast<int64_t>(std::filesystem::last_write_time(fileName).time_since_epoch().count());
+    if (waveformOffset > file.size() || waveformLength > file.size() - waveformOffset)
+    {
+        throw std::runtime_error("Waveform outside of the file.");
+    }
+    uint64_t hash = hashBytes(file.subview(0, waveformOffset));
+    uint64_t end = waveformOffset + waveformLength;
+    fingerprint.headerHash = hashBytes(file.subview(end, file.size() - end), hash);
+    return fingerprint;
+}
+
+ByteVector serializeFileIndex(const FileIndex &index)
+{
+    SidecarWriter writer(magic, FileIndex::version);
+    writer.value<uint64_t>(index.fingerprint.size);
+    writer.value<int64_t>(index.fingerprint.modificationTime);
+    writer.value<uint64_t>(index.fingerprint.headerHash);
+    writer.value<uint64_t>(index.waveformOffset);
+    writer.value<uint64_t>(index.waveformLength);
+    writer.value<uint64_t>(index.sequenceSize);
+    writer.value<uint32_t>(static_cast<uint32_t>(index.tagOffsets.size()));
+    for (uint64_t offset : index.tagOffsets)
+    {
+        writer.value<uint64_t>(offset);
+    }
+    writeHeader(writer, index.header);
+    return writer.finish();
+}
+
+FileIndex parseFileIndex(ByteView bytes)
+{
+    SidecarReader reader(bytes, magic, FileIndex::version, "file index");
+    FileIndex index;
+    index.fingerprint.size = reader.value<uint64_t>();
+    index.fingerprint.modificationTime = reader.value<int64_t>();
+    index.fingerprint.headerHash = reader.value<uint64_t>();
+    index.waveformOffset = reader.value<uint64_t>();
+    index.waveformLength = reader.value<uint64_t>();
+    index.sequenceSize = reader.value<uint64_t>();
+    uint32_t tagCount = reader.count(sizeof(uint64_t));
+    index.tagOffsets.reserve(tagCount);
+    for (uint32_t i = 0; i < tagCount; i++)
+    {
+        index.tagOffsets.push_back(reader.value<uint64_t>());
+    }
+    index.header = readHeader(reader);
+    reader.finish();
+    return index;
+}
+
+void writeFileIndex(const std::string &indexFileName, const FileIndex &index)
+{
+    writeSidecarFile(indexFileName, serializeFileIndex(index));
+}
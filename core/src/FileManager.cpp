@@ -18,7 +18,7 @@ void FileManager::writeLine(const std::string &line)
         return;
     }
 
-    outputFile << line << std::endl;
+    outputFile << line << '\n';
 }
 
 void FileManager::writeLines(const std::vector<std::string> &lines)
@@ -8,75 +8,85 @@
 #include <vector>
 #include <type_traits>
 #include <cmath>
+#include <cstring>
+#include <algorithm>
 
-std::unique_ptr<MFERData> parseMFERData(DataStack *dataStack)
+namespace
 {
-    try
+    MFERData *parseData(DataStack *dataStack, Arena *arena)
     {
-        uint8_t byte = dataStack->pop_byte();
-
-        switch (byte)
+        try
         {
-        case PRE::tag:
-            return std::make_unique<PRE>(dataStack);
-        case BLE::tag:
-            return std::make_unique<BLE>(dataStack);
-        case TXC::tag:
-            return std::make_unique<TXC>(dataStack);
-        case MAN::tag:
-            return std::make_unique<MAN>(dataStack);
-        case WFM::tag:
-            return std::make_unique<WFM>(dataStack);
-        case TIM::tag:
-            return std::make_unique<TIM>(dataStack);
-        case PID::tag:
-            return std::make_unique<PID>(dataStack);
-        case PNM::tag:
-            return std::make_unique<PNM>(dataStack);
-        case AGE::tag:
-            return std::make_unique<AGE>(dataStack);
-        case SEX::tag:
-            return std::make_unique<SEX>(dataStack);
-        case IVL::tag:
-            return std::make_unique<IVL>(dataStack);
-        case EVT::tag:
-            return std::make_unique<EVT>(dataStack);
-        case SEQ::tag:
-            return std::make_unique<SEQ>(dataStack);
-        case CHN::tag:
-            return std::make_unique<CHN>(dataStack);
-        case NUL::tag:
-            return std::make_unique<NUL>(dataStack);
-        case ATT::tag:
-            return std::make_unique<ATT>(dataStack);
-        case WAV::tag:
-            return std::make_unique<WAV>(dataStack);
-        case END::tag:
-            return std::make_unique<END>(dataStack);
-        case LDN::tag:
-            return std::make_unique<LDN>(dataStack);
-        case DTP::tag:
-            return std::make_unique<DTP>(dataStack);
-        case BLK::tag:
-            return std::make_unique<BLK>(dataStack);
-        case SEN::tag:
-            return std::make_unique<SEN>(dataStack);
-        default:
-            std::stringstream stream;
-            stream << "Invalid tag (int): " << (int)byte;
-            throw std::invalid_argument(stream.str());
+            uint8_t byte = dataStack->pop_byte();
+            MFERData *data = MFERDataTypes::create(byte, dataStack, arena);
+            if (data == nullptr)
+            {
+                std::stringstream stream;
+                stream << "Invalid tag (int): " << (int)byte;
+                throw std::invalid_argument(stream.str());
+            }
+            return data;
+        }
+        catch (const std::exception &e)
+        {
+            throw std::runtime_error("Error while parsing MFERData: " + std::string(e.what()));
         }
     }
-    catch (const std::exception &e)
+}
+
+std::unique_ptr<MFERData> parseMFERData(DataStack *dataStack)
+{
+    return std::unique_ptr<MFERData>(parseData(dataStack, nullptr));
+}
+
+MFERData *parseMFERData(DataStack *dataStack, Arena &arena)
+{
+    return parseData(dataStack, &arena);
+}
+
+MFERData::MFERData(DataStack *dataStack, Arena *arena)
+{
+    length = dataStack->pop_byte();
+    setContents(dataStack->pop_front(length), arena);
+}
+
+MFERData::MFERData(const ByteVector &contents) : length(contents.size())
+{
+    if (contents.size() > 0xFF)
     {
-        throw std::runtime_error("Error while parsing MFERData: " + std::string(e.what()));
+        throw std::runtime_error("Contents too long for a single length byte");
     }
+    setContents(contents, nullptr);
 }
 
-MFERData::MFERData(DataStack *dataStack)
+void MFERData::setContents(ByteView bytes, Arena *arena)
 {
-    length = dataStack->pop_byte();
-    contents = dataStack->pop_front(length);
+    if (bytes.size() <= localSize)
+    {
+        storage = localBytes;
+    }
+    else if (arena != nullptr)
+    {
+        storage = static_cast<uint8_t *>(arena->allocate(bytes.size(), 1));
+    }
+    else
+    {
+        ownedBytes.reset(new uint8_t[bytes.size()]);
+        storage = ownedBytes.get();
+    }
+    if (!bytes.empty())
+    {
+        std::memcpy(storage, bytes.data(), bytes.size());
+    }
+    contents = ByteView(storage, bytes.size());
+}
+
+void MFERData::fillContents(uint8_t value)
+{
+    if (!contents.empty())
+    {
+        std::memset(storage, value, contents.size());
+    }
 }
 
 std::string MFERData::toHexString(std::string left) const
@@ -93,28 +103,30 @@ std::string MFERData::toHexString(std::string left) const
 std::string MFERData::contentsString(std::string left) const
 {
     std::ostringstream stream;
-    if (contents.size() > (size_t)maxByteLength)
+    ByteView data = getContents();
+    if (data.size() > (size_t)maxByteLength)
     {
         stream << std::string("| ...");
     }
     else
     {
-        stream << "| " << contents.stringify();
+        stream << "| " << data.stringify();
     }
     return stream.str();
 }
 
-ByteVector MFERData::getContents() const
+void MFERData::write(ByteSink &sink) const
 {
-    return contents;
+    sink.write(getTag());
+    sink.write(static_cast<uint8_t>(length));
+    sink.write(getContents());
 }
 
 ByteVector MFERData::toByteVector() const
 {
     ByteVector byteVector;
-    byteVector.push_back(getTag());
-    byteVector.push_back(length);
-    byteVector.insert(byteVector.end(), contents.begin(), contents.end());
+    ByteVectorSink sink(byteVector);
+    write(sink);
     return byteVector;
 }
 
@@ -178,12 +190,12 @@ std::string TIM::getMeasurementTime(ByteOrder byteOrder) const
 
 void PID::anonymize()
 {
-    contents = ByteVector(length, 0x00);
+    fillContents(0x00);
 }
 
 void PNM::anonymize()
 {
-    contents = ByteVector(length, 0x00);
+    fillContents(0x00);
 }
 
 std::string AGE::getBirthDate(ByteOrder byteOrder) const
@@ -220,7 +232,7 @@ std::string AGE::getBirthDate(ByteOrder byteOrder) const
 
 void AGE::anonymize()
 {
-    contents = ByteVector(length, 0xFF);
+    fillContents(0xFF);
 }
 
 std::string SEX::getPatientSex() const
@@ -233,7 +245,7 @@ std::string SEX::getPatientSex() const
 
 void SEX::anonymize()
 {
-    contents = ByteVector(length, 0x00);
+    fillContents(0x00);
 }
 
 float IVL::getSamplingInterval() const
@@ -261,12 +273,81 @@ NIBPEvent EVT::getNIBPEvent(ByteOrder byteOrder) const
     return event;
 }
 
-ATT::ATT(DataStack *dataStack)
+ATT::ATT(DataStack *dataStack, Arena *arena)
 {
     channelIndex = dataStack->pop_byte();
     length = dataStack->pop_byte();
-    contents = dataStack->pop_front(length);
-    attributes = getAttributes();
+    setContents(dataStack->pop_front(length), arena);
+    parseAttributes(arena);
+}
+
+ATT::ATT(uint8_t channelIndex, const std::vector<std::unique_ptr<MFERData>> &attributes) : channelIndex(channelIndex)
+{
+    ByteVector bytes;
+    ByteVectorSink sink(bytes);
+    for (const auto &attribute : attributes)
+    {
+        attribute->write(sink);
+    }
+    if (bytes.size() > 0xFF)
+    {
+        throw std::runtime_error("Channel attributes too long for a single length byte");
+    }
+    length = bytes.size();
+    setContents(bytes, nullptr);
+    parseAttributes(nullptr);
+}
+
+void ATT::parseAttributes(Arena *arena)
+{
+    if (arena == nullptr)
+    {
+        ownedArena = std::make_unique<Arena>();
+        arena = ownedArena.get();
+    }
+
+    // Every attribute takes at least one byte of the contents, which fit a single length byte
+    MFERData *parsed[0x100];
+    size_t count = 0;
+    DataStack dataStack(contents);
+    while (dataStack.size() > 0)
+    {
+        MFERData *attribute = parseMFERData(&dataStack, *arena);
+        parsed[count++] = attribute;
+        if (attribute->getTag() == END::tag)
+        {
+            break;
+        }
+    }
+    attributes = arena->copyArray(parsed, count);
+
+    MFERDataVisitor decode{
+        [&](const LDN &ldn)
+        {
+            descriptor.hasLead = true;
+            descriptor.lead[0] = ldn.getLead(ByteOrder::ENDIAN_BIG);
+            descriptor.lead[1] = ldn.getLead(ByteOrder::ENDIAN_LITTLE);
+        },
+        [&](const DTP &dtp)
+        { descriptor.dataType = dtp.getDataType(); },
+        [&](const BLK &blk)
+        {
+            descriptor.blockLength[0] = blk.getBlockLength(ByteOrder::ENDIAN_BIG);
+            descriptor.blockLength[1] = blk.getBlockLength(ByteOrder::ENDIAN_LITTLE);
+        },
+        [&](const IVL &ivl)
+        { descriptor.interval = &ivl; },
+        [&](const SEN &sen)
+        {
+            descriptor.samplingResolution[0] = sen.getSamplingResolution(ByteOrder::ENDIAN_BIG);
+            descriptor.samplingResolution[1] = sen.getSamplingResolution(ByteOrder::ENDIAN_LITTLE);
+        },
+        [](const MFERData &) {},
+    };
+    for (const MFERData *attribute : attributes)
+    {
+        visitMFERData(*attribute, decode);
+    }
 }
 
 std::string ATT::contentsString(std::string left) const
@@ -276,7 +357,7 @@ std::string ATT::contentsString(std::string left) const
            << left << spacerString() << sectionString();
     std::ostringstream leftStream;
     leftStream << left << spacerString();
-    for (const auto &data : attributes)
+    for (const MFERData *data : attributes)
     {
         stream << "\n"
                << left << data->toHexString(leftStream.str());
@@ -284,80 +365,77 @@ std::string ATT::contentsString(std::string left) const
     return stream.str();
 }
 
-std::vector<std::unique_ptr<MFERData>> ATT::getAttributes() const
-{
-    return parseMFERDataCollection(contents);
-}
-
 Channel ATT::getChannel(ByteOrder byteOrder) const
 {
-    const std::vector<std::unique_ptr<MFERData>> channelAttributes = getAttributes();
+    size_t order = static_cast<size_t>(byteOrder);
     Channel channel;
-    for (const auto &attribute : channelAttributes)
+    if (descriptor.hasLead)
     {
-        if (LDN *ldn = dynamic_cast<LDN *>(attribute.get()))
-        {
-            channel.leadInfo = ldn->getLeadInfo(byteOrder);
-        }
-        else if (DTP *dtp = dynamic_cast<DTP *>(attribute.get()))
-        {
-            channel.dataType = dtp->getDataType();
-        }
-        else if (BLK *blk = dynamic_cast<BLK *>(attribute.get()))
-        {
-            channel.blockLength = blk->getContents().toInt<uint32_t>(byteOrder);
-        }
-        else if (IVL *ivl = dynamic_cast<IVL *>(attribute.get()))
-        {
-            channel.samplingInterval = ivl->getSamplingInterval();
-            channel.samplingIntervalString = ivl->getSamplingIntervalString();
-        }
-        else if (SEN *sen = dynamic_cast<SEN *>(attribute.get()))
-        {
-            channel.samplingResolution = sen->getSamplingResolution(byteOrder);
-        }
+        channel.leadInfo = findLeadInfo(descriptor.lead[order]);
     }
+    channel.dataType = descriptor.dataType;
+    channel.blockLength = descriptor.blockLength[order];
+    if (descriptor.interval != nullptr)
+    {
+        channel.samplingInterval = descriptor.interval->getSamplingInterval();
+        channel.samplingIntervalString = descriptor.interval->getSamplingIntervalString();
+    }
+    channel.samplingResolution = descriptor.samplingResolution[order];
     return channel;
 }
 
-ByteVector ATT::toByteVector() const
+void ATT::write(ByteSink &sink) const
 {
-    ByteVector byteVector;
-    byteVector.push_back(getTag());
-    byteVector.push_back(channelIndex);
-    byteVector.push_back(length);
-    byteVector.insert(byteVector.end(), contents.begin(), contents.end());
-    return byteVector;
+    sink.write(getTag());
+    sink.write(channelIndex);
+    sink.write(static_cast<uint8_t>(length));
+    sink.write(contents);
 }
 
-WAV::WAV(DataStack *dataStack)
+WAV::WAV(DataStack *dataStack, Arena *arena)
 {
     wordLength = dataStack->pop_byte();
-    lengthBytes = dataStack->pop_front((int)wordLength - 128);
-    length = lengthBytes.toInt<uint32_t>();
-    contents = dataStack->pop_front(length);
+    ByteView lengthView = dataStack->pop_front((int)wordLength - 128);
+    length = lengthView.toInt<uint32_t>();
+    std::copy(lengthView.begin(), lengthView.end(), lengthBytes);
+    ByteView payload = dataStack->pop_front(length);
+    if (dataStack->getSource())
+    {
+        contents = payload; // Reference the payload in place instead of copying it
+        if (arena == nullptr)
+        {
+            source = dataStack->getSource();
+        }
+    }
+    else
+    {
+        setContents(payload, arena);
+    }
 }
 
-ByteVector WAV::toByteVector() const
+void WAV::write(ByteSink &sink) const
 {
-    ByteVector byteVector;
-    byteVector.push_back(getTag());
-    byteVector.push_back(wordLength);
-    byteVector.insert(byteVector.end(), lengthBytes.begin(), lengthBytes.end());
-    byteVector.insert(byteVector.end(), contents.begin(), contents.end());
+    sink.write(getTag());
+    sink.write(wordLength);
+    sink.write(lengthBytes, wordLength - 128);
+    sink.write(getContents()); // Written from the source in place
+}
+
+ByteVector WAV::headerToByteVector(uint32_t length)
+{
+    ByteVector byteVector = {tag, 0x84, 0, 0, 0, 0};
+    storeValue<uint32_t>(byteVector.data() + 2, length, ByteOrder::ENDIAN_BIG);
     return byteVector;
 }
 
-END::END(DataStack *dataStack)
+END::END(DataStack *dataStack, Arena *arena)
 {
     length = 0x00;
 }
 
-ByteVector END::toByteVector() const
+void END::write(ByteSink &sink) const
 {
-    ByteVector byteVector;
-    byteVector.push_back(getTag());
-    return byteVector;
+    sink.write(getTag());
 }
 
 std::string END::contentsString(std::string left) const
@@ -365,9 +443,18 @@ std::string END::contentsString(std::string left) const
     return "| End of file.";
 }
 
+Lead LDN::getLead(ByteOrder byteOrder) const
+{
+    return static_cast<Lead>(contents.toInt<uint16_t>(byteOrder));
+}
+
 LeadInfo LDN::getLeadInfo(ByteOrder byteOrder) const
 {
-    Lead lead = static_cast<Lead>(contents.toInt<uint16_t>(byteOrder));
+    return findLeadInfo(getLead(byteOrder));
+}
+
+LeadInfo findLeadInfo(Lead lead)
+{
     auto it = LeadMap.find(lead);
     if (it == LeadMap.end())
     {
@@ -379,11 +466,39 @@ LeadInfo LDN::getLeadInfo(ByteOrder byteOrder) const
     return it->second;
 }
 
+uint32_t BLK::getBlockLength(ByteOrder byteOrder) const
+{
+    return contents.toInt<uint32_t>(byteOrder);
+}
+
 DataType DTP::getDataType() const
 {
     return static_cast<DataType>(contents[0]);
 }
 
+uint8_t getDataTypeSize(DataType dataType)
+{
+    switch (dataType)
+    {
+    case DataType::INT_8_U:
+    case DataType::INT_8_S:
+    case DataType::AHA_8:
+        return 1;
+    case DataType::INT_16_S:
+    case DataType::INT_16_U:
+    case DataType::STATUS_16:
+        return 2;
+    case DataType::INT_32_S:
+    case DataType::INT_32_U:
+    case DataType::FLOAT_32:
+        return 4;
+    case DataType::FLOAT_64:
+        return 8;
+    default:
+        throw std::runtime_error("Invalid data type");
+    }
+}
+
 float SEN::getSamplingResolution(ByteOrder byteOrder) const
 {
     DataStack dataStack(contents);
@@ -3,9 +3,25 @@
 #include <iostream>
 #include <sstream>
 
-MFERDataCollection::MFERDataCollection(ByteVector dataVector)
+MFERDataCollection::MFERDataCollection(ByteView dataView, std::shared_ptr<const void> source) : source(source)
 {
-    mferDataVector = parseMFERDataCollection(dataVector);
+    DataStack dataStack(dataView, std::move(source));
+    mferDataVector = parseMFERDataCollection(&dataStack, arena, &offsets);
+}
+
+MFERDataCollection::MFERDataCollection(ByteView dataView, std::shared_ptr<const void> source, const std::vector<uint64_t> &offsets)
+    : source(source), offsets(offsets)
+{
+    mferDataVector.reserve(offsets.size());
+    for (uint64_t offset : offsets)
+    {
+        if (offset > dataView.size())
+        {
+            throw std::runtime_error("Element offset outside of the data.");
+        }
+        DataStack dataStack(dataView.subview(offset, dataView.size() - offset), source);
+        mferDataVector.push_back(parseMFERData(&dataStack, arena));
+    }
 }
 
 std::string MFERDataCollection::toHexString(uint64_t maxByteLength) const
@@ -14,16 +30,45 @@ std::string MFERDataCollection::toHexString(uint64_t maxByteLength) const
     return collectionToHexString(&mferDataVector, "");
 }
 
-std::vector<std::unique_ptr<MFERData>> parseMFERDataCollection(ByteVector dataVector)
+std::vector<std::unique_ptr<MFERData>> parseMFERDataCollection(ByteView dataView)
+{
+    DataStack dataBlock(dataView);
+    return parseMFERDataCollection(&dataBlock);
+}
+
+std::vector<MFERData *> parseMFERDataCollection(DataStack *dataBlock, Arena &arena, std::vector<uint64_t> *offsets)
+{
+    std::vector<MFERData *> collection;
+    collection.reserve(64); // Headers of recordings hold a few dozen elements
+    size_t size = dataBlock->size();
+
+    while (dataBlock->size() > 0)
+    {
+        if (offsets != nullptr)
+        {
+            offsets->push_back(size - dataBlock->size());
+        }
+        MFERData *data = parseMFERData(dataBlock, arena);
+        collection.push_back(data);
+
+        // Exit if at end of file (tag 80)
+        if (dataBlock->size() <= 0 || data->getTag() == END::tag)
+        {
+            break;
+        }
+    }
+    return collection;
+}
+
+std::vector<std::unique_ptr<MFERData>> parseMFERDataCollection(DataStack *dataBlock)
 {
-    DataStack dataBlock(dataVector);
     std::vector<std::unique_ptr<MFERData>> collection;
 
-    while (dataBlock.size() > 0)
+    while (dataBlock->size() > 0)
     {
         try
         {
-            std::unique_ptr<MFERData> data = parseMFERData(&dataBlock);
+            std::unique_ptr<MFERData> data = parseMFERData(dataBlock);
 
             uint8_t tag = data->getTag();
 
@@ -31,7 +76,7 @@ std::vector<std::unique_ptr<MFERData>> parseMFERDataCollection(ByteVector dataVe
             collection.push_back(std::move(data));
 
             // Exit if at end of file (tag 80)
-            if (dataBlock.size() <= 0 || tag == 128)
+            if (dataBlock->size() <= 0 || tag == 128)
             {
                 break;
             }
@@ -44,7 +89,7 @@ std::vector<std::unique_ptr<MFERData>> parseMFERDataCollection(ByteVector dataVe
     return collection;
 }
 
-std::string collectionToHexString(const std::vector<std::unique_ptr<MFERData>> *collection, std::string left)
+std::string collectionToHexString(const std::vector<MFERData *> *collection, std::string left)
 {
     std::ostringstream stream;
     stream << MFERData::headerString() << "\n"
@@ -67,13 +112,31 @@ std::string collectionToHexString(const std::vector<std::unique_ptr<MFERData>> *
     return stream.str();
 }
 
-ByteVector MFERDataCollection::toByteVector() const
+void MFERDataCollection::write(ByteSink &sink) const
 {
-    ByteVector dataVector;
     for (const auto &data : mferDataVector)
     {
-        ByteVector dataBytes = data->toByteVector();
-        dataVector.insert(dataVector.end(), dataBytes.begin(), dataBytes.end());
+        data->write(sink);
     }
+}
+
+ByteVector MFERDataCollection::toByteVector() const
+{
+    ByteVector dataVector;
+    ByteVectorSink sink(dataVector);
+    write(sink);
     return dataVector;
-}
\ No newline at end of file
+}
+
+std::string collectionToHexString(const std::vector<std::unique_ptr<MFERData>> *collection, std::string left)
+{
+    std::vector<MFERData *> elements;
+    if (collection != nullptr)
+    {
+        for (const auto &data : *collection)
+        {
+            elements.push_back(data.get());
+        }
+    }
+    return collectionToHexString(&elements, left);
+}
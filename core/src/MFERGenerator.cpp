@@ -0,0 +1,260 @@
+#include "MFERGenerator.h"
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+    const std::vector<std::pair<DataType, std::string>> dataTypeNames = {
+        {DataType::INT_16_S, "int16s"},
+        {DataType::INT_16_U, "int16u"},
+        {DataType::INT_32_S, "int32s"},
+        {DataType::INT_8_U, "int8u"},
+        {DataType::STATUS_16, "status16"},
+        {DataType::INT_8_S, "int8s"},
+        {DataType::INT_32_U, "int32u"},
+        {DataType::FLOAT_32, "float32"},
+        {DataType::FLOAT_64, "float64"},
+    };
+
+    // SplitMix64, small and the same on every platform unlike the standard distributions
+    inline uint64_t nextRandom(uint64_t &state)
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    inline double toUnit(uint32_t bits) // [0, 1)
+    {
+        return bits * (1.0 / 4294967296.0);
+    }
+
+    template <typename T>
+    ByteVector valueBytes(T value, ByteOrder byteOrder)
+    {
+        ByteVector bytes(sizeof(T));
+        storeValue<T>(bytes.data(), value, byteOrder);
+        return bytes;
+    }
+
+    ByteVector paddedString(const std::string &text, size_t size)
+    {
+        ByteVector bytes(text.begin(), text.end());
+        bytes.resize(size, 0x00);
+        return bytes;
+    }
+
+    template <typename T>
+    void storeSample(uint8_t *output, double value, ByteOrder byteOrder)
+    {
+        storeValue<T>(output, static_cast<T>(std::lround(value)), byteOrder);
+    }
+
+    // Fills one block of a channel. The samples are a triangle wave with noise, seeded by the channel and
+    // sequence so each block is the same regardless of the order blocks are generated in.
+    void generateBlock(const GeneratorOptions &options, size_t channelIndex, uint16_t sequence, uint8_t *output)
+    {
+        const GeneratorChannel &channel = options.channels[channelIndex];
+        uint64_t state = options.seed ^ (static_cast<uint64_t>(channelIndex + 1) << 48) ^ (static_cast<uint64_t>(sequence) << 16);
+        nextRandom(state);
+        uint64_t period = 100 + 37 * channelIndex; // Samples per wave
+        uint64_t first = static_cast<uint64_t>(sequence) * channel.blockLength;
+        uint8_t size = getDataTypeSize(channel.dataType);
+
+        for (uint32_t i = 0; i < channel.blockLength; i++)
+        {
+            uint64_t random = nextRandom(state);
+            double phase = static_cast<double>((first + i) % period) / period;
+            double value = 4 * std::abs(phase - 0.5) - 1 + 0.1 * (toUnit(static_cast<uint32_t>(random)) - 0.5); // About -1 to 1
+            bool missing = toUnit(static_cast<uint32_t>(random >> 32)) < options.missingDensity;
+            uint8_t *sample = output + static_cast<size_t>(i) * size;
+
+            switch (channel.dataType)
+            {
+            case DataType::INT_16_S:
+                storeSample<int16_t>(sample, missing ? -32768 : value * 2000, options.byteOrder);
+                break;
+            case DataType::INT_16_U:
+                storeSample<uint16_t>(sample, (value + 1) * 2000, options.byteOrder);
+                break;
+            case DataType::STATUS_16:
+                storeValue<uint16_t>(sample, (random >> 54) == 0 ? 1 : 0, options.byteOrder); // Rare status marks
+                break;
+            case DataType::INT_32_S:
+                storeSample<int32_t>(sample, value * 100000, options.byteOrder);
+                break;
+            case DataType::INT_32_U:
+                storeSample<uint32_t>(sample, (value + 1) * 100000, options.byteOrder);
+                break;
+            case DataType::INT_8_S:
+                storeSample<int8_t>(sample, value * 100, options.byteOrder);
+                break;
+            case DataType::INT_8_U:
+                storeSample<uint8_t>(sample, (value + 1) * 100, options.byteOrder);
+                break;
+            case DataType::FLOAT_32:
+                storeValue<float>(sample, missing ? std::numeric_limits<float>::quiet_NaN() : static_cast<float>(value), options.byteOrder);
+                break;
+            case DataType::FLOAT_64:
+                storeValue<double>(sample, missing ? std::numeric_limits<double>::quiet_NaN() : value, options.byteOrder);
+                break;
+            default:
+                throw std::runtime_error("Unsupported data type");
+            }
+        }
+    }
+
+    // Header tags, in the order of resources/test-file.MWF
+    std::vector<std::unique_ptr<MFERData>> generateHeader(const GeneratorOptions &options)
+    {
+        ByteOrder byteOrder = options.byteOrder;
+        uint64_t random = options.seed;
+        std::vector<std::unique_ptr<MFERData>> header;
+        header.push_back(std::make_unique<PRE>(paddedString("MFR Monitoring Waveform", 32)));
+        header.push_back(std::make_unique<BLE>(ByteVector{static_cast<uint8_t>(byteOrder)}));
+        header.push_back(std::make_unique<TXC>(paddedString("ANSI X3.4", 10)));
+        header.push_back(std::make_unique<MAN>(paddedString("MONK^GENERATOR^0", 32)));
+        header.push_back(std::make_unique<WFM>(ByteVector{0x14}));
+
+        ByteVector time = valueBytes<uint16_t>(2020, byteOrder);
+        time.insert(time.end(), {1, 1, 0, 0, 0, 0, 0, 0, 0});
+        header.push_back(std::make_unique<TIM>(time));
+        header.push_back(std::make_unique<PID>(paddedString("SYN" + std::to_string(nextRandom(random) % 100000000), 17)));
+        header.push_back(std::make_unique<PNM>(paddedString("SYNTHETIC^PATIENT", 66)));
+        header.push_back(std::make_unique<AGE>(ByteVector(7, 0xFF)));
+        header.push_back(std::make_unique<SEX>(ByteVector{0x00}));
+        header.push_back(std::make_unique<IVL>(ByteVector{0x01, 0xFD, options.samplingInterval}));
+
+        uint64_t duration = static_cast<uint64_t>(options.sequenceCount) * options.channels[0].blockLength * options.channels[0].samplingInterval; // Milliseconds
+        for (uint32_t i = 0; i < options.eventCount; i++)
+        {
+            int systolic = 100 + static_cast<int>(nextRandom(random) % 60);
+            int diastolic = 60 + static_cast<int>(nextRandom(random) % 30);
+            ByteVector event = valueBytes<uint16_t>(0x0001, byteOrder);
+            ByteVector startTime = valueBytes<uint32_t>(static_cast<uint32_t>(duration * (i + 1) / (options.eventCount + 1)), byteOrder);
+            ByteVector eventDuration = valueBytes<uint32_t>(30000, byteOrder);
+            ByteVector information = paddedString("NIBP " + std::to_string(systolic) + "/" + std::to_string(diastolic) + " mmHg", 54);
+            event.insert(event.end(), startTime.begin(), startTime.end());
+            event.insert(event.end(), eventDuration.begin(), eventDuration.end());
+            event.insert(event.end(), information.begin(), information.end());
+            header.push_back(std::make_unique<EVT>(event));
+        }
+
+        header.push_back(std::make_unique<SEQ>(valueBytes<uint16_t>(options.sequenceCount, byteOrder)));
+        header.push_back(std::make_unique<CHN>(ByteVector{static_cast<uint8_t>(options.channels.size())}));
+        header.push_back(std::make_unique<NUL>(valueBytes<uint16_t>(0x8000, byteOrder)));
+
+        for (size_t i = 0; i < options.channels.size(); i++)
+        {
+            const GeneratorChannel &channel = options.channels[i];
+            std::vector<std::unique_ptr<MFERData>> attributes;
+            attributes.push_back(std::make_unique<LDN>(valueBytes<uint16_t>(static_cast<uint16_t>(channel.lead), byteOrder)));
+            attributes.push_back(std::make_unique<DTP>(ByteVector{static_cast<uint8_t>(channel.dataType)}));
+            attributes.push_back(std::make_unique<BLK>(valueBytes<uint32_t>(channel.blockLength, byteOrder)));
+            attributes.push_back(std::make_unique<IVL>(ByteVector{0x01, 0xFD, channel.samplingInterval}));
+            if (channel.resolutionBase != 0)
+            {
+                auto lead = LeadMap.find(channel.lead);
+                ByteVector resolution = {lead == LeadMap.end() ? uint8_t(0) : lead->second.unitCode, static_cast<uint8_t>(channel.resolutionExponent)};
+                ByteVector base = valueBytes<uint16_t>(channel.resolutionBase, byteOrder);
+                resolution.insert(resolution.end(), base.begin(), base.end());
+                attributes.push_back(std::make_unique<SEN>(resolution));
+            }
+            header.push_back(std::make_unique<ATT>(static_cast<uint8_t>(i), attributes));
+        }
+        return header;
+    }
+}
+
+std::string getDataTypeName(DataType dataType)
+{
+    for (const auto &entry : dataTypeNames)
+    {
+        if (entry.first == dataType)
+        {
+            return entry.second;
+        }
+    }
+    throw std::runtime_error("Unsupported data type");
+}
+
+DataType getDataTypeFromName(const std::string &name)
+{
+    for (const auto &entry : dataTypeNames)
+    {
+        if (entry.second == name)
+        {
+            return entry.first;
+        }
+    }
+    throw std::runtime_error("Unknown data type: " + name);
+}
+
+void generateMFER(const GeneratorOptions &options, ByteSink &sink)
+{
+    if (options.channels.empty() || options.channels.size() > 0xFF)
+    {
+        throw std::runtime_error("Channel count must be between 1 and 255");
+    }
+    if (options.missingDensity < 0 || options.missingDensity > 1)
+    {
+        throw std::runtime_error("Missing density must be between 0 and 1");
+    }
+    uint64_t sequenceSize = 0;
+    uint64_t sequenceDuration = static_cast<uint64_t>(options.channels[0].blockLength) * options.channels[0].samplingInterval;
+    for (const GeneratorChannel &channel : options.channels)
+    {
+        getDataTypeName(channel.dataType); // Throws for data types without a generator
+        if (channel.blockLength == 0 || channel.samplingInterval == 0)
+        {
+            throw std::runtime_error("Block length and sampling interval must be greater than 0");
+        }
+        if (static_cast<uint64_t>(channel.blockLength) * channel.samplingInterval != sequenceDuration)
+        {
+            throw std::runtime_error("Channels must span the same duration per sequence");
+        }
+        sequenceSize += static_cast<uint64_t>(channel.blockLength) * getDataTypeSize(channel.dataType);
+    }
+    uint64_t waveformSize = sequenceSize * options.sequenceCount;
+    if (waveformSize > std::numeric_limits<uint32_t>::max())
+    {
+        throw std::runtime_error("Waveform larger than 4 GiB");
+    }
+
+    for (const auto &data : generateHeader(options))
+    {
+        data->write(sink);
+    }
+
+    sink.write(WAV::headerToByteVector(static_cast<uint32_t>(waveformSize)));
+    std::vector<uint8_t> sequence(sequenceSize);
+    for (uint16_t i = 0; i < options.sequenceCount; i++)
+    {
+        uint64_t offset = 0;
+        for (size_t k = 0; k < options.channels.size(); k++)
+        {
+            generateBlock(options, k, i, sequence.data() + offset);
+            offset += static_cast<uint64_t>(options.channels[k].blockLength) * getDataTypeSize(options.channels[k].dataType);
+        }
+        sink.write(sequence.data(), sequence.size());
+    }
+
+    END().write(sink);
+}
+
+ByteVector generateMFER(const GeneratorOptions &options)
+{
+    ByteVector output;
+    ByteVectorSink sink(output);
+    generateMFER(options, sink);
+    return output;
+}
+
+void generateMFERFile(const std::string &fileName, const GeneratorOptions &options)
+{
+    BinaryWriter file(fileName);
+    generateMFER(options, file);
+    file.close();
+}
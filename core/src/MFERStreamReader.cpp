@@ -0,0 +1,177 @@
+#include "MFERStreamReader.h"
+#include "DataStack.h"
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+MFERStreamReader::MFERStreamReader(std::istream &input, size_t chunkSize) : input(&input), chunkSize(std::max<size_t>(chunkSize, 1))
+{
+}
+
+MFERStreamReader::MFERStreamReader(int fileDescriptor, size_t chunkSize) : fileDescriptor(fileDescriptor), chunkSize(std::max<size_t>(chunkSize, 1))
+{
+}
+
+size_t MFERStreamReader::readSome(uint8_t *destination, size_t num)
+{
+    size_t total = 0;
+    while (total < num)
+    {
+        if (input != nullptr)
+        {
+            input->read(reinterpret_cast<char *>(destination + total), num - total);
+            std::streamsize count = input->gcount();
+            if (count <= 0)
+            {
+                break;
+            }
+            total += static_cast<size_t>(count);
+        }
+        else
+        {
+#ifdef _WIN32
+            int count = _read(fileDescriptor, destination + total, static_cast<unsigned int>(std::min<size_t>(num - total, 1 << 30)));
+#else
+            ssize_t count = ::read(fileDescriptor, destination + total, num - total);
+#endif
+            if (count < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (count < 0)
+            {
+                throw std::runtime_error("Error reading stream.");
+            }
+            if (count == 0)
+            {
+                break;
+            }
+            total += static_cast<size_t>(count);
+        }
+    }
+    return total;
+}
+
+void MFERStreamReader::read(size_t num)
+{
+    size_t start = buffer.size();
+    buffer.resize(start + num);
+    if (readSome(buffer.data() + start, num) != num)
+    {
+        throw std::runtime_error("Error while reading data, unexpected end of stream.");
+    }
+    offset += num;
+}
+
+bool MFERStreamReader::next(Item &item)
+{
+    item.element.reset();
+    item.waveform = ByteView();
+    buffer.clear();
+
+    if (waveformRemaining > 0)
+    {
+        readWaveformChunk(item);
+        return true;
+    }
+    if (finished)
+    {
+        return false;
+    }
+
+    item.offset = offset;
+    uint8_t tag;
+    if (readSome(&tag, 1) == 0)
+    {
+        finished = true; // End of stream without an end of file tag
+        return false;
+    }
+    offset += 1;
+    buffer.push_back(tag);
+
+    try
+    {
+        switch (tag)
+        {
+        case END::tag:
+            finished = true;
+            item.type = ItemType::END;
+            return true;
+        case WAV::tag:
+        {
+            read(1); // Word length
+            uint8_t wordLength = buffer[1];
+            read(wordLength - 128);
+            waveformLength = ByteView(buffer).subview(2, wordLength - 128).toInt<uint32_t>();
+            waveformRemaining = waveformLength;
+            readWaveformChunk(item);
+            return true;
+        }
+        case ATT::tag:
+            read(2); // Channel index and length
+            read(buffer[2]);
+            break;
+        default:
+            read(1);
+            read(buffer[1]);
+            break;
+        }
+
+        DataStack dataStack{ByteView(buffer)}; // The element is copied out of the buffer while parsing
+        item.element = parseMFERData(&dataStack);
+    }
+    catch (const std::exception &e)
+    {
+        throw std::runtime_error("Error while streaming MFERData: " + std::string(e.what()));
+    }
+
+    item.type = ItemType::ELEMENT;
+    track(*item.element);
+    return true;
+}
+
+void MFERStreamReader::readWaveformChunk(Item &item)
+{
+    // Chunks hold whole sequences where the channel layout is known
+    uint64_t chunkLength = chunkSize;
+    if (sequenceSize > 0)
+    {
+        chunkLength = std::max<uint64_t>(chunkSize / sequenceSize, 1) * sequenceSize;
+    }
+    chunkLength = std::min(chunkLength, waveformRemaining);
+
+    buffer.clear();
+    item.type = ItemType::WAVEFORM;
+    item.offset = offset;
+    read(static_cast<size_t>(chunkLength));
+    item.waveform = ByteView(buffer);
+    waveformRemaining -= chunkLength;
+}
+
+void MFERStreamReader::track(const MFERData &data)
+{
+    switch (data.getTag())
+    {
+    case BLE::tag:
+        byteOrder = static_cast<const BLE &>(data).getByteOrder();
+        break;
+    case SEQ::tag:
+        sequenceCount = data.getContents().toInt<uint16_t>(byteOrder);
+        break;
+    case ATT::tag:
+    {
+        Channel channel = static_cast<const ATT &>(data).getChannel(byteOrder);
+        sequenceSize += static_cast<uint64_t>(channel.blockLength) * getDataTypeSize(channel.dataType);
+        channels.push_back(channel);
+        break;
+    }
+    default:
+        break;
+    }
+}
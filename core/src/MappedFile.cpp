@@ -0,0 +1,129 @@
+#include "MappedFile.h"
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+std::shared_ptr<const MappedFile> MappedFile::open(const std::string &fileName, Access access)
+{
+    return std::make_shared<const MappedFile>(fileName, access);
+}
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string &fileName, Access access)
+{
+    DWORD flags = access == Access::SEQUENTIAL ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL;
+    fileHandle = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        fileHandle = nullptr;
+        throw std::runtime_error("Error opening file.");
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize))
+    {
+        unmap();
+        throw std::runtime_error("Error reading file.");
+    }
+    length = static_cast<size_t>(fileSize.QuadPart);
+    if (length == 0)
+    {
+        return; // Empty files cannot be mapped
+    }
+
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle == nullptr)
+    {
+        unmap();
+        throw std::runtime_error("Error mapping file.");
+    }
+    address = static_cast<const uint8_t *>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (address == nullptr)
+    {
+        unmap();
+        throw std::runtime_error("Error mapping file.");
+    }
+}
+
+void MappedFile::unmap()
+{
+    if (address != nullptr)
+    {
+        UnmapViewOfFile(address);
+        address = nullptr;
+    }
+    if (mappingHandle != nullptr)
+    {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+    }
+    if (fileHandle != nullptr)
+    {
+        CloseHandle(fileHandle);
+        fileHandle = nullptr;
+    }
+    length = 0;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string &fileName, Access access)
+{
+    int fileDescriptor = ::open(fileName.c_str(), O_RDONLY);
+    if (fileDescriptor < 0)
+    {
+        throw std::runtime_error("Error opening file.");
+    }
+
+    struct stat fileStat;
+    if (fstat(fileDescriptor, &fileStat) != 0)
+    {
+        ::close(fileDescriptor);
+        throw std::runtime_error("Error reading file.");
+    }
+    length = static_cast<size_t>(fileStat.st_size);
+    if (length == 0)
+    {
+        ::close(fileDescriptor);
+        return; // Empty files cannot be mapped
+    }
+
+    void *mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    ::close(fileDescriptor); // The mapping holds its own reference to the file
+    if (mapping == MAP_FAILED)
+    {
+        length = 0;
+        throw std::runtime_error("Error mapping file.");
+    }
+    address = static_cast<const uint8_t *>(mapping);
+
+    madvise(mapping, length, access == Access::SEQUENTIAL ? MADV_SEQUENTIAL : MADV_NORMAL);
+}
+
+void MappedFile::unmap()
+{
+    if (address != nullptr)
+    {
+        munmap(const_cast<uint8_t *>(address), length);
+        address = nullptr;
+    }
+    length = 0;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
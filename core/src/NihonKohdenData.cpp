@@ -1,121 +1,391 @@
 #include "NihonKohdenData.h"
+#include "FileIndex.h"
+#include "SampleDecoder.h"
 #include <iostream>
 #include <cstdint>
 #include <limits>
 #include <sstream>
 #include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <filesystem>
 
-// Forward declaration
-std::vector<double> popChannelData(DataStack &waveformDataStack, uint64_t num, DataType dataType, ByteOrder byteOrder);
-
-NihonKohdenData::NihonKohdenData(ByteVector dataVector)
+NihonKohdenData::NihonKohdenData(ByteView dataView)
 {
-    collection = MFERDataCollection(dataVector);
+    collection = MFERDataCollection(dataView);
+    parsed = true;
+    buildIndex();
 }
 
-Header NihonKohdenData::collectDataFields(const std::vector<std::unique_ptr<MFERData>> &mferDataVector) const
+NihonKohdenData::NihonKohdenData(const std::string &fileName, bool useIndex) : sourceFileName(fileName)
 {
-    Header fields;
-
-    Encoding encoding = Encoding::UTF8;
-
-    for (const auto &data : mferDataVector)
+    // Samples are read in windows anywhere in the waveform, which sequential read-ahead and reclaim would work against
+    file = MappedFile::open(fileName, MappedFile::Access::NORMAL);
+    if (useIndex && readIndex())
     {
-        if (PRE *pre = dynamic_cast<PRE *>(data.get()))
-        {
-            fields.preamble = pre->toString();
-        }
-        else if (BLE *ble = dynamic_cast<BLE *>(data.get()))
-        {
-            fields.byteOrder = ble->getByteOrder();
-        }
-        else if (TXC *txc = dynamic_cast<TXC *>(data.get()))
-        {
-            encoding = txc->getEncoding();
-        }
-        else if (MAN *man = dynamic_cast<MAN *>(data.get()))
-        {
-            fields.modelInfo = man->toString(encoding);
-        }
-        else if (WFM *wfm = dynamic_cast<WFM *>(data.get()))
-        {
-            fields.waveformType = wfm->getWaveformType();
-        }
-        else if (TIM *tim = dynamic_cast<TIM *>(data.get()))
-        {
-            fields.measurementTimeISO = tim->getMeasurementTime(fields.byteOrder);
-        }
-        else if (PID *pid = dynamic_cast<PID *>(data.get()))
+        return;
+    }
+    parseCollection();
+    buildIndex();
+    uint64_t waveformOffset = waveform.empty() ? 0 : static_cast<uint64_t>(waveform.data() - file->data());
+    fingerprint = std::make_shared<const FileFingerprint>(::getFingerprint(sourceFileName, file->view(), waveformOffset, waveform.size()));
+    if (useIndex)
+    {
+        try
         {
-            fields.patientID = pid->toString(encoding);
+            writeIndex();
         }
-        else if (PNM *pnm = dynamic_cast<PNM *>(data.get()))
+        catch (const std::exception &)
         {
-            fields.patientName = pnm->toString(encoding);
+            // The index only speeds up reopening, so files in read-only directories are opened without one
         }
-        else if (AGE *age = dynamic_cast<AGE *>(data.get()))
+    }
+}
+
+void NihonKohdenData::parseCollection() const
+{
+    if (parsed)
+    {
+        return;
+    }
+    // The waveform payload is read in place from the mapping
+    collection = tagOffsets.empty() ? MFERDataCollection(file->view(), file) : MFERDataCollection(file->view(), file, tagOffsets);
+    parsed = true;
+}
+
+bool NihonKohdenData::readIndex()
+{
+    try
+    {
+        std::string indexFileName = getIndexFileName(sourceFileName);
+        if (!std::filesystem::exists(indexFileName))
         {
-            fields.birthDateISO = age->getBirthDate(fields.byteOrder);
+            return false;
         }
-        else if (SEX *sex = dynamic_cast<SEX *>(data.get()))
+        FileIndex index = parseFileIndex(MappedFile(indexFileName).view());
+        if (::getFingerprint(sourceFileName, file->view(), index.waveformOffset, index.waveformLength) != index.fingerprint)
         {
-            fields.patientSex = sex->getPatientSex();
+            return false;
         }
-        else if (IVL *ivl = dynamic_cast<IVL *>(data.get()))
+        fingerprint = std::make_shared<const FileFingerprint>(index.fingerprint);
+
+        header = std::move(index.header);
+        for (Channel &channel : header.channels)
         {
-            fields.samplingInterval = ivl->getSamplingInterval();
-            fields.samplingIntervalString = ivl->getSamplingIntervalString();
+            channel.data = ChannelData(channel.dataType, channel.samplingResolution);
         }
-        else if (EVT *evt = dynamic_cast<EVT *>(data.get()))
+        waveform = file->view().subview(index.waveformOffset, index.waveformLength);
+        tagOffsets = std::move(index.tagOffsets);
+        readPatientFields();
+        indexHeader();
+        if (sequenceSize != index.sequenceSize)
         {
-            fields.events.push_back(evt->getNIBPEvent(fields.byteOrder));
+            throw std::runtime_error("Sequence size does not match the index.");
         }
-        else if (SEQ *seq = dynamic_cast<SEQ *>(data.get()))
+        indexed = true;
+        return true;
+    }
+    catch (const std::exception &)
+    {
+        tagOffsets.clear(); // Parse the file from the start instead
+        fingerprint.reset();
+        return false;
+    }
+}
+
+// Patient fields are left out of the index, so that a file anonymized in place keeps no copy of them beside it.
+// They are decoded from their tags instead, along with the tags they depend on.
+void NihonKohdenData::readPatientFields()
+{
+    const std::vector<uint8_t> tags = {BLE::tag, TXC::tag, PID::tag, PNM::tag, AGE::tag, SEX::tag};
+    std::vector<uint64_t> offsets;
+    for (uint64_t offset : tagOffsets)
+    {
+        if (offset < file->size() && std::find(tags.begin(), tags.end(), file->data()[offset]) != tags.end())
         {
-            fields.sequenceCount = seq->getContents().toInt<uint16_t>(fields.byteOrder);
+            offsets.push_back(offset);
         }
-        else if (CHN *chn = dynamic_cast<CHN *>(data.get()))
+    }
+    MFERDataCollection patientTags(file->view(), file, offsets);
+    Header fields = collectDataFields(patientTags.getMFERDataVector());
+    header.patientID = fields.patientID;
+    header.patientName = fields.patientName;
+    header.birthDateISO = fields.birthDateISO;
+    header.patientSex = fields.patientSex;
+}
+
+void NihonKohdenData::writeIndex() const
+{
+    FileIndex index;
+    index.tagOffsets = collection.getOffsets();
+    index.header = header;
+    for (Channel &channel : index.header.channels)
+    {
+        channel.data = ChannelData();
+    }
+    index.waveformOffset = waveform.empty() ? 0 : static_cast<uint64_t>(waveform.data() - file->data());
+    index.waveformLength = waveform.size();
+    index.sequenceSize = sequenceSize;
+    index.fingerprint = getFingerprint();
+    writeFileIndex(getIndexFileName(sourceFileName), index);
+}
+
+FileFingerprint NihonKohdenData::getFingerprint() const
+{
+    if (!fingerprint)
+    {
+        throw std::runtime_error("Data is not read from a file.");
+    }
+    return *fingerprint;
+}
+
+void NihonKohdenData::buildIndex()
+{
+    waveform = ByteView();
+    header = collectDataFields(collection.getMFERDataVector());
+    indexHeader();
+}
+
+void NihonKohdenData::indexHeader()
+{
+    cache = header;
+    decodedChannels.assign(header.channels.size(), false);
+    if (channelSelection.size() != header.channels.size())
+    {
+        channelSelection.assign(header.channels.size(), true);
+    }
+    indexSequences();
+}
+
+// The size of a sequence is fixed by the block lengths and data types, so any sample can be located by offset
+void NihonKohdenData::indexSequences()
+{
+    sequenceSize = 0;
+    channelOffsets.clear();
+    for (const auto &channel : header.channels)
+    {
+        channelOffsets.push_back(sequenceSize);
+        sequenceSize += static_cast<uint64_t>(channel.blockLength) * getDataTypeSize(channel.dataType);
+    }
+    // Samples are read from the waveform by offset without further checks, so every sequence must be in it
+    if (!waveform.empty() && waveform.size() / std::max<uint64_t>(sequenceSize, 1) < header.sequenceCount)
+    {
+        throw std::runtime_error("Waveform is shorter than the sequences in the header.");
+    }
+}
+
+// Collects header fields and channel descriptors, and locates the waveform payload without decoding it
+Header NihonKohdenData::collectDataFields(const std::vector<MFERData *> &mferDataVector)
+{
+    Header fields;
+
+    Encoding encoding = Encoding::UTF8;
+    bool finished = false;
+
+    MFERDataVisitor collect{
+        [&](const PRE &pre)
+        { fields.preamble = pre.toString(); },
+        [&](const BLE &ble)
+        { fields.byteOrder = ble.getByteOrder(); },
+        [&](const TXC &txc)
+        { encoding = txc.getEncoding(); },
+        [&](const MAN &man)
+        { fields.modelInfo = man.toString(encoding); },
+        [&](const WFM &wfm)
+        { fields.waveformType = wfm.getWaveformType(); },
+        [&](const TIM &tim)
+        { fields.measurementTimeISO = tim.getMeasurementTime(fields.byteOrder); },
+        [&](const PID &pid)
+        { fields.patientID = pid.toString(encoding); },
+        [&](const PNM &pnm)
+        { fields.patientName = pnm.toString(encoding); },
+        [&](const AGE &age)
+        { fields.birthDateISO = age.getBirthDate(fields.byteOrder); },
+        [&](const SEX &sex)
+        { fields.patientSex = sex.getPatientSex(); },
+        [&](const IVL &ivl)
         {
-            fields.channelCount = chn->getContents()[0];
-        }
-        else if (data->getTag() == NUL::tag)
+            fields.samplingInterval = ivl.getSamplingInterval();
+            fields.samplingIntervalString = ivl.getSamplingIntervalString();
+        },
+        [&](const EVT &evt)
+        { fields.events.push_back(evt.getNIBPEvent(fields.byteOrder)); },
+        [&](const SEQ &seq)
+        { fields.sequenceCount = seq.getContents().toInt<uint16_t>(fields.byteOrder); },
+        [&](const CHN &chn)
+        { fields.channelCount = chn.getContents()[0]; },
+        [](const NUL &)
         {
             // null value
-        }
-        else if (ATT *att = dynamic_cast<ATT *>(data.get()))
+        },
+        [&](const ATT &att)
         {
-            fields.channels.push_back(att->getChannel(fields.byteOrder));
-        }
-        else if (WAV *wav = dynamic_cast<WAV *>(data.get()))
+            Channel channel = att.getChannel(fields.byteOrder);
+            channel.data = ChannelData(channel.dataType, channel.samplingResolution);
+            fields.channels.push_back(channel);
+        },
+        [&](const WAV &wav)
+        { waveform = wav.getContents(); },
+        [&](const END &)
+        { finished = true; },
+        [](const MFERData &data)
+        { std::cerr << "Unknown tag: " << data.getTag() << std::endl; },
+    };
+
+    for (const MFERData *data : mferDataVector)
+    {
+        visitMFERData(*data, collect);
+        if (finished)
         {
-            DataStack waveformDataStack(wav->getContents());
-            for (uint16_t i = 0; i < fields.sequenceCount; i++) // For each sequence
-            {
-                for (auto &channel : fields.channels) // For each channel
-                {
-                    std::vector<double> sequenceData = popChannelData(waveformDataStack, channel.blockLength, channel.dataType, fields.byteOrder); // Pop the channel data according to the block length and data type size
-                    channel.data.insert(channel.data.end(), sequenceData.begin(), sequenceData.end());                                             // Add the sequence data to the channel data
-                }
-            }
+            break; // end of file
         }
-        else if (data->getTag() == END::tag)
+    }
+    return fields;
+}
+
+const Header &NihonKohdenData::getHeader() const
+{
+    for (size_t i = 0; i < cache.channels.size(); i++)
+    {
+        if (channelSelection[i])
         {
-            break; // end of file
+            getChannelData(i); // Decodes the selected channels not requested yet
         }
-        else
+    }
+    return cache;
+}
+
+const ChannelData &NihonKohdenData::getChannelData(size_t index) const
+{
+    if (index >= header.channels.size())
+    {
+        throw std::runtime_error("Channel index out of range");
+    }
+    if (decodedChannels[index])
+    {
+        return cache.channels[index].data;
+    }
+
+    const Channel &channel = header.channels[index];
+    uint64_t blockSize = static_cast<uint64_t>(channel.blockLength) * getDataTypeSize(channel.dataType);
+    ChannelData data(channel.dataType, channel.samplingResolution);
+    if (!waveform.empty())
+    {
+        data.reserve(static_cast<size_t>(header.sequenceCount) * channel.blockLength);
+        for (uint16_t i = 0; i < header.sequenceCount; i++) // For each sequence
         {
-            std::cerr << "Unknown tag: " << data->getTag() << std::endl;
+            ByteView block = waveform.subview(i * sequenceSize + channelOffsets[index], blockSize);
+            data.append(block.data(), channel.blockLength, header.byteOrder); // Samples are kept in their native data type
         }
     }
-    return fields;
+
+    cache.channels[index].data = std::move(data);
+    decodedChannels[index] = true;
+    return cache.channels[index].data;
+}
+
+SamplePosition NihonKohdenData::getSamplePosition(size_t index, double time) const
+{
+    if (index >= header.channels.size())
+    {
+        throw std::runtime_error("Channel index out of range");
+    }
+    if (time < 0)
+    {
+        throw std::runtime_error("Time must be greater than or equal to 0");
+    }
+    const Channel &channel = header.channels[index];
+    if (channel.blockLength == 0 || channel.samplingInterval <= 0)
+    {
+        return {0, 0};
+    }
+    double last = static_cast<double>(header.sequenceCount) * channel.blockLength; // First sample after the recording
+    uint64_t sample = static_cast<uint64_t>(std::min(std::floor(time / channel.samplingInterval), last));
+    return {static_cast<uint32_t>(sample / channel.blockLength), static_cast<uint32_t>(sample % channel.blockLength)};
+}
+
+// Calls visit with the part of a range of samples of a channel within each sequence, without allocating
+template <typename Visitor>
+void NihonKohdenData::forEachSampleBlock(size_t index, uint64_t first, uint64_t count, Visitor &&visit) const
+{
+    if (count > getSampleCount(index) || first > getSampleCount(index) - count)
+    {
+        throw std::runtime_error("Sample index out of range");
+    }
+
+    const Channel &channel = header.channels[index];
+    uint8_t sampleSize = getDataTypeSize(channel.dataType);
+    uint64_t sequence = channel.blockLength == 0 ? 0 : first / channel.blockLength;
+    uint64_t offset = channel.blockLength == 0 ? 0 : first % channel.blockLength;
+    while (count > 0)
+    {
+        uint64_t num = std::min<uint64_t>(count, channel.blockLength - offset);
+        visit(waveform.data() + sequence * sequenceSize + channelOffsets[index] + offset * sampleSize, num);
+        count -= num;
+        sequence++;
+        offset = 0;
+    }
+}
+
+uint64_t NihonKohdenData::getSampleCount(size_t index) const
+{
+    if (index >= header.channels.size())
+    {
+        throw std::runtime_error("Channel index out of range");
+    }
+    return waveform.empty() ? 0 : static_cast<uint64_t>(header.sequenceCount) * header.channels[index].blockLength;
+}
+
+void NihonKohdenData::readSamples(size_t index, uint64_t startSample, uint64_t count, double *output) const
+{
+    decodeChannelRange(index, startSample, count, output); // Checks the channel and the range
+}
+
+void NihonKohdenData::decodeChannelRange(size_t index, uint64_t first, uint64_t count, double *output) const
+{
+    DataType dataType = header.channels[index].dataType;
+    forEachSampleBlock(index, first, count, [&](const uint8_t *samples, uint64_t num)
+                       {
+        decodeSamples(samples, num, dataType, header.byteOrder, output);
+        output += num; });
+}
+
+void NihonKohdenData::copyChannelRange(size_t index, uint64_t first, uint64_t count, ChannelData &output) const
+{
+    output.reserve(output.size() + count);
+    forEachSampleBlock(index, first, count, [&](const uint8_t *samples, uint64_t num)
+                       { output.append(samples, num, header.byteOrder); });
 }
 
 void NihonKohdenData::anonymize()
 {
+    parseCollection();
     for (const auto &data : collection.getMFERDataVector())
     {
         data->anonymize();
     }
+
+    // Anonymization only rewrites header fields. The cached channels are updated in place, so decoded
+    // channel data and references into the cache stay valid.
+    std::vector<Channel> channels = std::move(cache.channels);
+    header = collectDataFields(collection.getMFERDataVector());
+    cache = header;
+    if (channels.size() != cache.channels.size())
+    {
+        buildIndex();
+        return;
+    }
+    for (size_t i = 0; i < channels.size(); i++)
+    {
+        ChannelData data = std::move(channels[i].data);
+        channels[i] = cache.channels[i];
+        channels[i].data = std::move(data);
+    }
+    cache.channels = std::move(channels);
+    indexSequences();
 }
 
 void NihonKohdenData::setChannelSelection(int index, bool active)
@@ -130,6 +400,23 @@ void NihonKohdenData::setChannelSelection(int index, bool active)
     }
 }
 
+void NihonKohdenData::setChannelSelection(Lead lead, bool active)
+{
+    bool found = false;
+    for (size_t i = 0; i < header.channels.size(); i++)
+    {
+        if (header.channels[i].leadInfo.lead == lead)
+        {
+            channelSelection[i] = active;
+            found = true;
+        }
+    }
+    if (!found)
+    {
+        throw std::runtime_error("No channel with the given lead");
+    }
+}
+
 void NihonKohdenData::setIntervalSelection(double start, double end)
 {
     if (start < 0)
@@ -148,8 +435,28 @@ void NihonKohdenData::setIntervalSelection(double start, double end)
     intervalSelection.end = end;
 }
 
+void NihonKohdenData::setResampling(double samplingInterval, ResampleMode mode)
+{
+    if (samplingInterval < 0)
+    {
+        throw std::runtime_error("Resampling interval must be greater than or equal to 0");
+    }
+    std::vector<Resampler> channelResamplers;
+    if (samplingInterval > 0)
+    {
+        for (size_t i = 0; i < header.channels.size(); i++)
+        {
+            channelResamplers.emplace_back(header.channels[i].samplingInterval, samplingInterval, mode, getSampleCount(i));
+        }
+    }
+    resamplers = std::move(channelResamplers);
+    resamplingInterval = samplingInterval;
+    resamplingMode = mode;
+}
+
 void NihonKohdenData::printHexData() const
 {
+    parseCollection();
     std::cout << std::endl
               << collection.toHexString() << std::endl;
 }
@@ -180,142 +487,689 @@ std::string Header::toString() const
 
 void NihonKohdenData::printHeader() const
 {
-    Header header = collectDataFields(collection.getMFERDataVector());
     std::cout << "\nHeader: \n";
     std::cout << header.toString() << std::endl;
 }
 
 void NihonKohdenData::writeToBinary(const std::string &fileName) const
 {
-    FileManager::writeBinaryFile(fileName, collection.toByteVector());
+    // The waveform is read from the mapped source file, so the source is replaced only once the copy is complete
+    std::error_code error;
+    bool replacesSource = !sourceFileName.empty() && std::filesystem::equivalent(sourceFileName, fileName, error);
+    std::string outputFileName = replacesSource ? fileName + ".part" : fileName;
+
+    parseCollection();
+    try
+    {
+        BinaryWriter output(outputFileName);
+        collection.write(output);
+        output.close();
+        if (replacesSource)
+        {
+            std::filesystem::rename(outputFileName, fileName);
+        }
+    }
+    catch (...)
+    {
+        if (replacesSource)
+        {
+            std::filesystem::remove(outputFileName, error);
+        }
+        throw;
+    }
+}
+
+// Rows of csv and arrow output are the samples of the selected channel with the largest block length
+NihonKohdenData::OutputLayout NihonKohdenData::getOutputLayout() const
+{
+    OutputLayout layout;
+    layout.samplingInterval = header.samplingInterval;
+    size_t rowChannel = 0; // Selected channel with the most samples per sequence, one per row
+    for (size_t i = 0; i < header.channels.size(); i++) // Get channel selection & lowest sampling interval
+    {
+        if (channelSelection[i])
+        {
+            layout.channels.push_back(i);
+            if (header.channels[i].blockLength > layout.largestBlockLength)
+            {
+                layout.largestBlockLength = header.channels[i].blockLength;
+                layout.samplingInterval = header.channels[i].samplingInterval;
+                rowChannel = i;
+            }
+        }
+    }
+    for (size_t index : layout.channels)
+    {
+        layout.channelIntervals.push_back(layout.largestBlockLength / header.channels[index].blockLength);
+    }
+
+    // Rows from the first at or after the start of the interval to the last at or before its end. The times are
+    // located in the channel the rows follow, so only the sequences holding those rows are decoded. A row is written
+    // with the time row * samplingInterval, which the division in getSamplePosition may round past by one row.
+    uint64_t rowCount = static_cast<uint64_t>(header.sequenceCount) * layout.largestBlockLength;
+    auto getRow = [&](double time) // Last row at or before time
+    {
+        SamplePosition position = getSamplePosition(rowChannel, time);
+        uint64_t row = std::min<uint64_t>(static_cast<uint64_t>(position.sequence) * layout.largestBlockLength + position.sample, rowCount);
+        if (row < rowCount && (row + 1) * layout.samplingInterval <= time)
+        {
+            row++;
+        }
+        else if (row > 0 && row * layout.samplingInterval > time)
+        {
+            row--;
+        }
+        return row;
+    };
+    layout.firstRow = 0;
+    layout.lastRow = rowCount;
+    if (rowCount > 0 && layout.samplingInterval > 0)
+    {
+        layout.firstRow = getRow(intervalSelection.start);
+        if (layout.firstRow < rowCount && layout.firstRow * layout.samplingInterval < intervalSelection.start)
+        {
+            layout.firstRow++; // Start between rows
+        }
+        if (intervalSelection.end != 0)
+        {
+            layout.lastRow = std::max(std::min(getRow(intervalSelection.end) + 1, rowCount), layout.firstRow);
+        }
+    }
+    else if (intervalSelection.start > 0)
+    {
+        layout.lastRow = 0; // Every row is at time 0
+    }
+    layout.firstSequence = 0;
+    layout.lastSequence = 0;
+    if (layout.firstRow < layout.lastRow)
+    {
+        layout.firstSequence = static_cast<uint32_t>(layout.firstRow / layout.largestBlockLength);
+        layout.lastSequence = static_cast<uint32_t>((layout.lastRow - 1) / layout.largestBlockLength + 1);
+    }
+    return layout;
 }
 
-void NihonKohdenData::writeToCsv(const std::string &fileName) const
+// Samples of a selected channel used by the rows of a range of sequences, as a range of sample indices
+std::pair<uint64_t, uint64_t> NihonKohdenData::getSampleRange(const OutputLayout &layout, size_t channel, uint32_t firstSequence, uint32_t lastSequence) const
 {
-    Header header = collectDataFields(collection.getMFERDataVector());
-    std::cout << "\nWriting waveform data to " << fileName << std::endl;
-    FileManager file(fileName);
+    uint64_t sampleCount = waveform.empty() ? 0 : static_cast<uint64_t>(header.sequenceCount) * header.channels[layout.channels[channel]].blockLength;
+    uint64_t first = (firstSequence * layout.largestBlockLength) / layout.channelIntervals[channel];
+    uint64_t last = std::min<uint64_t>((lastSequence * layout.largestBlockLength - 1) / layout.channelIntervals[channel] + 1, sampleCount);
+    return {std::min(first, last), last};
+}
 
-    // Get channel selection
-    std::vector<Channel> outputChannels;
-    for (int i = 0; i < header.channels.size(); i++)
+NihonKohdenData::ResampledLayout NihonKohdenData::getResampledLayout() const
+{
+    if (resamplingInterval <= 0 || resamplers.size() != header.channels.size())
+    {
+        throw std::runtime_error("Resampling is not set");
+    }
+    ResampledLayout layout;
+    uint64_t rowCount = 0; // Rows until the end of the longest channel
+    for (size_t i = 0; i < header.channels.size(); i++)
     {
         if (channelSelection[i])
         {
-            outputChannels.push_back(header.channels[i]);
+            layout.channels.push_back(i);
         }
+        rowCount = std::max(rowCount, resamplers[i].getOutputCount());
     }
 
-    // Write csv header & get lowest sampling interval
-    std::stringstream channelsHeader;
-    uint64_t largestBlockLength = 0;
-    double samplingInterval = header.samplingInterval;
-    for (auto channel : outputChannels)
+    // Rows at or after start and at or before end, as the timestamps of the csv output
+    double first = std::ceil(intervalSelection.start / resamplingInterval - 1e-9);
+    layout.firstRow = static_cast<uint64_t>(std::min(first, static_cast<double>(rowCount)));
+    layout.lastRow = rowCount;
+    if (intervalSelection.end != 0)
     {
-        channelsHeader << ", " << channel.leadInfo.attribute << ": " << channel.leadInfo.samplingResolution;
-        if (channel.blockLength > largestBlockLength)
+        double last = std::floor(intervalSelection.end / resamplingInterval + 1e-9) + 1;
+        layout.lastRow = static_cast<uint64_t>(std::clamp(last, static_cast<double>(layout.firstRow), static_cast<double>(rowCount)));
+    }
+    return layout;
+}
+
+// Resamples the rows of each selected channel, decoding only the samples they use
+void NihonKohdenData::resampleRows(const ResampledLayout &layout, uint64_t firstRow, uint64_t count, std::vector<std::vector<double>> &columns) const
+{
+    std::vector<double> samples;
+    columns.resize(layout.channels.size());
+    for (size_t k = 0; k < layout.channels.size(); k++)
+    {
+        const Resampler &resampler = resamplers[layout.channels[k]];
+        std::pair<uint64_t, uint64_t> range = resampler.getSourceRange(firstRow, count);
+        samples.resize(range.second - range.first);
+        readSamples(layout.channels[k], range.first, samples.size(), samples.data());
+        columns[k].resize(count);
+        resampler.resample(samples.data(), firstRow, count, columns[k].data());
+    }
+}
+
+uint64_t NihonKohdenData::getResampledRowCount() const
+{
+    ResampledLayout layout = getResampledLayout();
+    return layout.lastRow - layout.firstRow;
+}
+
+void NihonKohdenData::readResampled(uint64_t firstRow, uint64_t count, double *output) const
+{
+    ResampledLayout layout = getResampledLayout();
+    if (firstRow > layout.lastRow - layout.firstRow || count > layout.lastRow - layout.firstRow - firstRow)
+    {
+        throw std::runtime_error("Row index out of range");
+    }
+    std::vector<std::vector<double>> columns;
+    resampleRows(layout, layout.firstRow + firstRow, count, columns);
+    size_t width = layout.channels.size() + 1;
+    for (uint64_t i = 0; i < count; i++)
+    {
+        double *row = output + i * width;
+        row[0] = (layout.firstRow + firstRow + i) * resamplingInterval;
+        for (size_t k = 0; k < columns.size(); k++)
+        {
+            row[k + 1] = columns[k][i];
+        }
+    }
+}
+
+// Formats count parts on worker threads and passes them to write in order, keeping at most two parts per thread in memory
+template <typename Format, typename Write>
+void formatInOrder(uint32_t count, unsigned int threads, int precision, const Format &format, const Write &write)
+{
+    // No more workers than parts or cores, as each one holds two parts of text
+    threads = std::min({threads, std::max(std::thread::hardware_concurrency(), 1u), std::max(count, 1u)});
+    size_t window = 2 * static_cast<size_t>(threads);
+    std::vector<CsvWriter> parts;
+    for (size_t i = 0; i < window; i++)
+    {
+        parts.emplace_back(precision);
+    }
+    std::vector<bool> ready(window, false);
+    uint32_t next = 0;    // Next part to format
+    uint32_t written = 0; // Parts passed to write
+    bool failed = false;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable changed;
+
+    auto work = [&]()
+    {
+        while (true)
+        {
+            uint32_t i;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&]
+                             { return failed || next >= count || next < written + window; });
+                if (failed || next >= count)
+                {
+                    return;
+                }
+                i = next++;
+            }
+            try
+            {
+                parts[i % window].clear();
+                format(i, parts[i % window]);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!failed)
+                {
+                    failed = true;
+                    error = std::current_exception();
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ready[i % window] = true;
+            }
+            changed.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned int i = 0; i < threads; i++)
+    {
+        workers.emplace_back(work);
+    }
+
+    try
+    {
+        for (uint32_t i = 0; i < count; i++)
         {
-            largestBlockLength = channel.blockLength;
-            samplingInterval = channel.samplingInterval;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&]
+                             { return failed || ready[i % window]; });
+                if (failed)
+                {
+                    break;
+                }
+            }
+            write(i, parts[i % window]);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ready[i % window] = false;
+                written++;
+            }
+            changed.notify_all();
+        }
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!failed)
+        {
+            failed = true;
+            error = std::current_exception();
         }
     }
-    std::stringstream headerStream;
-    headerStream << "Time: "
-                 << "(s)" << channelsHeader.str();
 
-    file.writeLine(headerStream.str()); // Write header to file
+    changed.notify_all();
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
 
-    // Get interval timestamps
-    double start = intervalSelection.start;
-    double end = intervalSelection.end;
-    if (intervalSelection.end == 0)
+void NihonKohdenData::writeToCsv(const std::string &fileName, int precision, unsigned int threads) const
+{
+    if (threads == 0)
     {
-        end = header.sequenceCount * largestBlockLength * samplingInterval;
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
     }
+    if (verbose)
+    {
+        std::cout << "\nWriting waveform data to " << fileName << std::endl;
+    }
+    CsvWriter file(fileName, precision);
+
+    OutputLayout layout = getOutputLayout();
+    size_t channelCount = layout.channels.size();
 
-    // Write waveform data
-    std::vector<std::string> lines;
-    lines.reserve(header.sequenceCount * largestBlockLength);
+    // Write csv header
+    std::stringstream channelsHeader;
+    for (size_t index : layout.channels)
+    {
+        const Channel &channel = header.channels[index];
+        channelsHeader << ", " << channel.leadInfo.attribute << ": " << channel.leadInfo.samplingResolution;
+    }
+    file.write("Time: (s)" + channelsHeader.str()); // Write header to file
+    file.endLine();
 
-    std::vector<int> channelIntervals(outputChannels.size());
-    for (size_t i = 0; i < outputChannels.size(); i++)
+    if (resamplingInterval > 0)
     {
-        channelIntervals[i] = largestBlockLength / outputChannels[i].blockLength;
+        writeResampledCsv(file, precision, threads);
+        return;
     }
 
-    std::cout << "0 / " << header.sequenceCount << " sequences processed";
+    // Write waveform data, rows are formatted straight into the output buffer
+    uint64_t largestBlockLength = layout.largestBlockLength;
+    const std::vector<int> &channelIntervals = layout.channelIntervals;
+    uint32_t firstSequence = layout.firstSequence;
+    uint32_t sequenceCount = layout.lastSequence - layout.firstSequence;
 
-    for (uint16_t i = 0; i < header.sequenceCount; i++) // For each sequence
+    auto formatSequence = [&](uint32_t i, CsvWriter &output)
     {
-        for (uint64_t j = 0; j < largestBlockLength; j++) // For each block
+        // Decode the samples of this sequence straight from the waveform, only while formatting it
+        std::vector<std::vector<double>> values(channelCount);
+        std::vector<uint64_t> firstIndices(channelCount);
+        for (size_t k = 0; k < channelCount; k++)
         {
-            double timestamp = (i * largestBlockLength + j) * samplingInterval; // Calculate timestamp
-            if (timestamp >= start && timestamp <= end)                         // If timestamp is within interval
+            std::pair<uint64_t, uint64_t> range = getSampleRange(layout, k, i, i + 1);
+            values[k].resize(range.second - range.first);
+            decodeChannelRange(layout.channels[k], range.first, range.second - range.first, values[k].data());
+            firstIndices[k] = range.first;
+        }
+
+        uint64_t firstRow = std::max<uint64_t>(layout.firstRow, i * largestBlockLength) - i * largestBlockLength;
+        uint64_t lastRow = std::min<uint64_t>(layout.lastRow, (i + 1) * largestBlockLength) - i * largestBlockLength;
+        for (uint64_t j = firstRow; j < lastRow; j++) // For each block within the interval
+        {
+            double timestamp = (i * largestBlockLength + j) * layout.samplingInterval; // Calculate timestamp
+            output.writeNumber(timestamp);           // Write timestamp
+            for (size_t k = 0; k < channelCount; k++) // For each channel
             {
-                std::stringstream line;                            // Create a new line
-                line << timestamp;                                 // Write timestamp
-                for (size_t k = 0; k < outputChannels.size(); k++) // For each channel
+                output.writeSeparator();
+                if (channelIntervals[k] == 1) // If the channel has the same block length as the largest block length, then write the value
                 {
-                    if (channelIntervals[k] == 1) // If the channel has the same block length as the largest block length, then write the value
+                    if (j < values[k].size())
                     {
-                        line << ", " << outputChannels[k].data[i * largestBlockLength + j];
+                        output.writeNumber(values[k][j]);
                     }
-                    else // If the channel has a different block length, then write the value if the index is a multiple of the interval
+                }
+                else if (j % channelIntervals[k] == 0) // If the channel has a different block length, then write the value if the index is a multiple of the interval
+                {
+                    uint64_t index = (i * largestBlockLength + j) / channelIntervals[k] - firstIndices[k];
+                    if (index < values[k].size())
                     {
-                        if (j % channelIntervals[k] == 0)
-                        {
-                            line << ", " << outputChannels[k].data[(i * largestBlockLength + j) / channelIntervals[k]];
-                        }
-                        else
-                        {
-                            line << ", ";
-                        }
+                        output.writeNumber(values[k][index]);
                     }
                 }
-                lines.push_back(line.str());
             }
+            output.endLine();
         }
-        std::cout << "\r" << (i + 1) << " / " << header.sequenceCount << " sequences processed";
+    };
+
+    if (verbose)
+    {
+        std::cout << "0 / " << sequenceCount << " sequences processed";
     }
-    std::cout << "\rProcessing complete. " << header.sequenceCount << " sequences processed.\n";
 
-    file.writeLines(lines);
-    file.closeFile();
+    if (threads == 1)
+    {
+        for (uint32_t i = 0; i < sequenceCount; i++) // For each sequence
+        {
+            formatSequence(firstSequence + i, file);
+            if (verbose)
+            {
+                std::cout << "\r" << (i + 1) << " / " << sequenceCount << " sequences processed";
+            }
+        }
+    }
+    else
+    {
+        // Sequences are formatted concurrently and written in order, so the output is the same as with one thread
+        formatInOrder(
+            sequenceCount, threads, precision, [&](uint32_t i, CsvWriter &output)
+            { formatSequence(firstSequence + i, output); },
+            [&](uint32_t i, const CsvWriter &text)
+            {
+                file.write(text);
+                if (verbose)
+                {
+                    std::cout << "\r" << (i + 1) << " / " << sequenceCount << " sequences processed";
+                } });
+    }
+    file.close();
 
-    std::cout << "Complete." << std::endl;
+    if (verbose)
+    {
+        std::cout << "\rProcessing complete. " << sequenceCount << " sequences processed.\n";
+        std::cout << "Complete." << std::endl;
+    }
 }
 
-std::vector<double> popChannelData(DataStack &waveformDataStack, uint64_t num, DataType dataType, ByteOrder byteOrder)
+// Rows of the resampled channels, resampled and formatted in parts of rowsPerPart rows
+void NihonKohdenData::writeResampledCsv(CsvWriter &file, int precision, unsigned int threads) const
 {
-    switch (dataType)
+    constexpr uint64_t rowsPerPart = 1 << 14;
+    ResampledLayout layout = getResampledLayout();
+    uint64_t rowCount = layout.lastRow - layout.firstRow;
+    uint32_t partCount = static_cast<uint32_t>((rowCount + rowsPerPart - 1) / rowsPerPart);
+
+    auto formatPart = [&](uint32_t i, CsvWriter &output)
     {
-    case DataType::INT_16_S:
+        uint64_t firstRow = layout.firstRow + i * rowsPerPart;
+        uint64_t count = std::min(rowsPerPart, layout.lastRow - firstRow);
+        std::vector<std::vector<double>> columns;
+        resampleRows(layout, firstRow, count, columns);
+        for (uint64_t j = 0; j < count; j++)
+        {
+            output.writeNumber((firstRow + j) * resamplingInterval);
+            for (const std::vector<double> &column : columns)
+            {
+                output.writeSeparator();
+                output.writeNumber(column[j]);
+            }
+            output.endLine();
+        }
+    };
+    auto reportProgress = [&](uint32_t i)
     {
-        auto values = waveformDataStack.pop_doubles<int16_t>(num, byteOrder);
-        for (auto &v : values)
-            if (v == -32768.0)
-                v = std::numeric_limits<double>::quiet_NaN();
-        return values;
+        if (verbose)
+        {
+            std::cout << "\r" << std::min((i + 1) * rowsPerPart, rowCount) << " / " << rowCount << " rows processed";
+        }
+    };
+
+    if (verbose)
+    {
+        std::cout << "0 / " << rowCount << " rows processed";
     }
+    if (threads == 1)
+    {
+        for (uint32_t i = 0; i < partCount; i++)
+        {
+            formatPart(i, file);
+            reportProgress(i);
+        }
+    }
+    else
+    {
+        formatInOrder(partCount, threads, precision, formatPart, [&](uint32_t i, const CsvWriter &text)
+                      {
+            file.write(text);
+            reportProgress(i); });
+    }
+    file.close();
+
+    if (verbose)
+    {
+        std::cout << "\rProcessing complete. " << rowCount << " rows processed.\n";
+        std::cout << "Complete." << std::endl;
+    }
+}
+
+// Arrow type holding the samples of a data type without conversion
+static ArrowType getArrowType(DataType dataType)
+{
+    switch (dataType)
+    {
+    case DataType::INT_16_S:
+        return ArrowType::INT_16;
     case DataType::INT_16_U:
-        return waveformDataStack.pop_doubles<uint16_t>(num, byteOrder);
-    case DataType::INT_32_S:
-        return waveformDataStack.pop_doubles<int32_t>(num, byteOrder);
-    case DataType::INT_8_U:
-        return waveformDataStack.pop_doubles<uint8_t>(num, byteOrder);
     case DataType::STATUS_16:
-        return waveformDataStack.pop_doubles<uint16_t>(num, byteOrder);
+        return ArrowType::UINT_16;
+    case DataType::INT_32_S:
+        return ArrowType::INT_32;
     case DataType::INT_8_S:
-        return waveformDataStack.pop_doubles<int8_t>(num, byteOrder);
+        return ArrowType::INT_8;
     case DataType::INT_32_U:
-        return waveformDataStack.pop_doubles<uint32_t>(num, byteOrder);
+        return ArrowType::UINT_32;
     case DataType::FLOAT_32:
-        return waveformDataStack.pop_doubles<float>(num, byteOrder);
+        return ArrowType::FLOAT_32;
     case DataType::FLOAT_64:
-        return waveformDataStack.pop_doubles<double>(num, byteOrder);
-    case DataType::AHA_8:
-        return waveformDataStack.pop_doubles<uint8_t>(num, byteOrder);
+        return ArrowType::FLOAT_64;
     default:
-        throw std::runtime_error("Invalid data type");
+        return ArrowType::UINT_8;
+    }
+}
+
+static std::string trimNulls(const std::string &string)
+{
+    return string.substr(0, string.find('\0'));
+}
+
+static ArrowMetadata getFieldMetadata(const Channel &channel)
+{
+    char scale[32];
+    std::to_chars_result result = std::to_chars(scale, scale + sizeof(scale), channel.samplingResolution);
+    return {{"lead", std::to_string(static_cast<uint16_t>(channel.leadInfo.lead))},
+            {"unit", channel.leadInfo.samplingResolution},
+            {"scale", std::string(scale, result.ptr)},
+            {"sampling_interval", channel.samplingIntervalString}};
+}
+
+void NihonKohdenData::writeToArrow(const std::string &fileName, uint32_t sequencesPerBatch) const
+{
+    if (sequencesPerBatch == 0)
+    {
+        throw std::runtime_error("Sequences per batch must be greater than 0");
+    }
+    if (verbose)
+    {
+        std::cout << "\nWriting waveform data to " << fileName << std::endl;
+    }
+    if (resamplingInterval > 0)
+    {
+        writeResampledArrow(fileName, sequencesPerBatch);
+        return;
+    }
+
+    OutputLayout layout = getOutputLayout();
+    size_t channelCount = layout.channels.size();
+
+    // Channels are stored in their native type. Rows without a sample of a slower channel, and missing
+    // INT_16_S samples, are null.
+    std::vector<ArrowField> fields;
+    fields.push_back({"Time", ArrowType::FLOAT_64, false, {{"unit", "s"}}});
+    for (size_t k = 0; k < channelCount; k++)
+    {
+        const Channel &channel = header.channels[layout.channels[k]];
+        bool nullable = layout.channelIntervals[k] != 1 || channel.dataType == DataType::INT_16_S;
+        fields.push_back({trimNulls(channel.leadInfo.attribute), getArrowType(channel.dataType), nullable, getFieldMetadata(channel)});
+    }
+    ArrowMetadata metadata = {{"measurement_time", trimNulls(header.measurementTimeISO)},
+                              {"sampling_interval", trimNulls(header.samplingIntervalString)},
+                              {"model", trimNulls(header.modelInfo)}};
+    ArrowWriter file(fileName, fields, metadata);
+
+    uint64_t largestBlockLength = layout.largestBlockLength;
+    for (uint64_t firstSequence = layout.firstSequence; firstSequence < layout.lastSequence; firstSequence += sequencesPerBatch) // For each batch
+    {
+        uint32_t lastSequence = static_cast<uint32_t>(std::min<uint64_t>(firstSequence + sequencesPerBatch, layout.lastSequence));
+
+        // Samples of each channel used by the batch
+        std::vector<ChannelData> samples;
+        std::vector<uint64_t> firstIndices;
+        for (size_t k = 0; k < channelCount; k++)
+        {
+            const Channel &channel = header.channels[layout.channels[k]];
+            std::pair<uint64_t, uint64_t> range = getSampleRange(layout, k, static_cast<uint32_t>(firstSequence), lastSequence);
+            samples.emplace_back(channel.dataType, channel.samplingResolution);
+            copyChannelRange(layout.channels[k], range.first, range.second - range.first, samples.back());
+            firstIndices.push_back(range.first);
+        }
+
+        std::vector<double> time;
+        std::vector<ByteVector> values(channelCount);
+        std::vector<ByteVector> validity(channelCount);
+        std::vector<uint64_t> nullCounts(channelCount, 0);
+        for (uint64_t i = firstSequence; i < lastSequence; i++) // For each sequence
+        {
+            uint64_t firstRow = std::max<uint64_t>(layout.firstRow, i * largestBlockLength) - i * largestBlockLength;
+            uint64_t lastRow = std::min<uint64_t>(layout.lastRow, (i + 1) * largestBlockLength) - i * largestBlockLength;
+            for (uint64_t j = firstRow; j < lastRow; j++) // For each block within the interval
+            {
+                double timestamp = (i * largestBlockLength + j) * layout.samplingInterval;
+                uint64_t row = time.size();
+                time.push_back(timestamp);
+                for (size_t k = 0; k < channelCount; k++) // For each channel
+                {
+                    ByteView bytes = samples[k].getBytes();
+                    size_t sampleSize = getDataTypeSize(samples[k].getDataType());
+                    uint64_t index = (i * largestBlockLength + j) / layout.channelIntervals[k] - firstIndices[k];
+                    bool valid = j % layout.channelIntervals[k] == 0 && index < samples[k].size();
+                    if (valid)
+                    {
+                        values[k].insert(values[k].end(), bytes.begin() + index * sampleSize, bytes.begin() + (index + 1) * sampleSize);
+                        valid = samples[k].getDataType() != DataType::INT_16_S || samples[k].samples<int16_t>()[index] != -32768;
+                    }
+                    else
+                    {
+                        values[k].insert(values[k].end(), sampleSize, 0);
+                    }
+
+                    if (row % 8 == 0)
+                    {
+                        validity[k].push_back(0);
+                    }
+                    if (valid)
+                    {
+                        validity[k][row / 8] |= 1 << (row % 8);
+                    }
+                    else
+                    {
+                        nullCounts[k]++;
+                    }
+                }
+            }
+        }
+        if (time.empty())
+        {
+            continue;
+        }
+
+        std::vector<ArrowColumn> columns;
+        columns.push_back({reinterpret_cast<const uint8_t *>(time.data())});
+        for (size_t k = 0; k < channelCount; k++)
+        {
+            columns.push_back({values[k].data(), validity[k].data(), nullCounts[k]});
+        }
+        file.writeBatch(time.size(), columns);
+    }
+    file.close();
+
+    if (verbose)
+    {
+        std::cout << "Complete." << std::endl;
+    }
+}
+
+// Resampled channels are stored as float64, with missing samples as null, in batches of about sequencesPerBatch sequences
+void NihonKohdenData::writeResampledArrow(const std::string &fileName, uint32_t sequencesPerBatch) const
+{
+    ResampledLayout layout = getResampledLayout();
+    size_t channelCount = layout.channels.size();
+
+    std::vector<ArrowField> fields;
+    fields.push_back({"Time", ArrowType::FLOAT_64, false, {{"unit", "s"}}});
+    for (size_t index : layout.channels)
+    {
+        const Channel &channel = header.channels[index];
+        fields.push_back({trimNulls(channel.leadInfo.attribute), ArrowType::FLOAT_64, true, getFieldMetadata(channel)});
+    }
+    char interval[32];
+    std::to_chars_result result = std::to_chars(interval, interval + sizeof(interval), resamplingInterval);
+    ArrowMetadata metadata = {{"measurement_time", trimNulls(header.measurementTimeISO)},
+                              {"sampling_interval", std::string(interval, result.ptr) + " (s)"},
+                              {"resampling", getResampleModeName(resamplingMode)},
+                              {"model", trimNulls(header.modelInfo)}};
+    ArrowWriter file(fileName, fields, metadata);
+
+    double sequenceDuration = header.channels.empty() ? 0 : header.channels[0].blockLength * static_cast<double>(header.channels[0].samplingInterval);
+    uint64_t rowsPerBatch = std::max<uint64_t>(static_cast<uint64_t>(std::llround(sequencesPerBatch * sequenceDuration / resamplingInterval)), 1);
+    std::vector<std::vector<double>> columns;
+    for (uint64_t firstRow = layout.firstRow; firstRow < layout.lastRow; firstRow += rowsPerBatch) // For each batch
+    {
+        uint64_t count = std::min(rowsPerBatch, layout.lastRow - firstRow);
+        resampleRows(layout, firstRow, count, columns);
+
+        std::vector<double> time(count);
+        for (uint64_t i = 0; i < count; i++)
+        {
+            time[i] = (firstRow + i) * resamplingInterval;
+        }
+        std::vector<ByteVector> validity(channelCount, ByteVector((count + 7) / 8, 0));
+        std::vector<uint64_t> nullCounts(channelCount, 0);
+        std::vector<ArrowColumn> arrowColumns;
+        arrowColumns.push_back({reinterpret_cast<const uint8_t *>(time.data())});
+        for (size_t k = 0; k < channelCount; k++)
+        {
+            for (uint64_t i = 0; i < count; i++)
+            {
+                if (std::isnan(columns[k][i]))
+                {
+                    nullCounts[k]++;
+                }
+                else
+                {
+                    validity[k][i / 8] |= 1 << (i % 8);
+                }
+            }
+            arrowColumns.push_back({reinterpret_cast<const uint8_t *>(columns[k].data()), validity[k].data(), nullCounts[k]});
+        }
+        file.writeBatch(count, arrowColumns);
+    }
+    file.close();
+
+    if (verbose)
+    {
+        std::cout << "Complete." << std::endl;
     }
 }
@@ -0,0 +1,216 @@
+#include "Resampler.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace
+{
+    const std::vector<std::pair<ResampleMode, std::string>> resampleModeNames = {
+        {ResampleMode::HOLD, "hold"},
+        {ResampleMode::LINEAR, "linear"},
+        {ResampleMode::POLYPHASE, "polyphase"},
+    };
+
+    constexpr double pi = 3.14159265358979323846;
+
+    uint64_t toMicroseconds(double interval)
+    {
+        double microseconds = std::round(interval * 1e6);
+        if (!(microseconds >= 1) || microseconds > 1e12)
+        {
+            throw std::runtime_error("Sampling intervals must be between 1 microsecond and 1000000 seconds");
+        }
+        return static_cast<uint64_t>(microseconds);
+    }
+
+    double sinc(double x)
+    {
+        return x == 0 ? 1 : std::sin(pi * x) / (pi * x);
+    }
+
+    double blackman(double x) // Window over -1 to 1
+    {
+        return std::abs(x) >= 1 ? 0 : 0.42 + 0.5 * std::cos(pi * x) + 0.08 * std::cos(2 * pi * x);
+    }
+
+    // Independent sums, so the products are pipelined and vectorized by the compiler
+    inline double dot(const double *samples, const double *filter, int count)
+    {
+        double sums[4] = {0, 0, 0, 0};
+        int i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            sums[0] += samples[i] * filter[i];
+            sums[1] += samples[i + 1] * filter[i + 1];
+            sums[2] += samples[i + 2] * filter[i + 2];
+            sums[3] += samples[i + 3] * filter[i + 3];
+        }
+        for (; i < count; i++)
+        {
+            sums[0] += samples[i] * filter[i];
+        }
+        return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+    }
+}
+
+ResampleMode getResampleMode(const std::string &name)
+{
+    for (const auto &entry : resampleModeNames)
+    {
+        if (entry.second == name)
+        {
+            return entry.first;
+        }
+    }
+    throw std::runtime_error("Unknown resample mode: " + name);
+}
+
+std::string getResampleModeName(ResampleMode mode)
+{
+    for (const auto &entry : resampleModeNames)
+    {
+        if (entry.first == mode)
+        {
+            return entry.second;
+        }
+    }
+    throw std::runtime_error("Unknown resample mode");
+}
+
+Resampler::Resampler(double sourceInterval, double targetInterval, ResampleMode mode, uint64_t sampleCount)
+    : mode(mode), sampleCount(sampleCount)
+{
+    uint64_t source = toMicroseconds(sourceInterval);
+    uint64_t target = toMicroseconds(targetInterval);
+    uint64_t divisor = std::gcd(source, target);
+    up = source / divisor;
+    down = target / divisor;
+    getResampleModeName(mode); // Throws for modes out of range
+
+    if (mode == ResampleMode::POLYPHASE)
+    {
+        // Cutoff relative to the source Nyquist rate, lowered to the target Nyquist rate when downsampling
+        double cutoff = std::min(1.0, static_cast<double>(up) / down);
+        double halfWidth = zeroCrossings / cutoff;
+        tapCount = 2 * static_cast<int>(std::ceil(halfWidth));
+        phaseCount = static_cast<uint32_t>(std::min<uint64_t>({up, maxPhases, std::max<uint64_t>(maxFilterSize / tapCount, 1)}));
+
+        filters.resize(static_cast<size_t>(phaseCount) * tapCount);
+        for (uint32_t phase = 0; phase < phaseCount; phase++)
+        {
+            double *filter = filters.data() + static_cast<size_t>(phase) * tapCount;
+            double offset = static_cast<double>(phase) / phaseCount;
+            double sum = 0;
+            for (int k = 0; k < tapCount; k++)
+            {
+                double distance = offset + (tapCount / 2 - 1 - k); // From tap k to the output, in source samples
+                filter[k] = cutoff * sinc(cutoff * distance) * blackman(distance / halfWidth);
+                sum += filter[k];
+            }
+            for (int k = 0; k < tapCount; k++)
+            {
+                filter[k] /= sum; // Unit gain for constant signals
+            }
+        }
+    }
+}
+
+uint64_t Resampler::getOutputCount() const
+{
+    return (sampleCount * up + down - 1) / down;
+}
+
+std::pair<uint64_t, uint32_t> Resampler::getFilterPosition(uint64_t output) const
+{
+    uint64_t position = output * down;
+    uint64_t sample = position / up;
+    uint64_t remainder = position % up;
+    if (phaseCount == up)
+    {
+        return {sample, static_cast<uint32_t>(remainder)};
+    }
+    uint64_t phase = (remainder * phaseCount + up / 2) / up;
+    return phase == phaseCount ? std::make_pair(sample + 1, 0u) : std::make_pair(sample, static_cast<uint32_t>(phase));
+}
+
+std::pair<uint64_t, uint64_t> Resampler::getSourceRange(uint64_t firstOutput, uint64_t count) const
+{
+    if (count == 0 || sampleCount == 0)
+    {
+        return {0, 0};
+    }
+    int64_t first = static_cast<int64_t>(firstOutput * down / up);
+    int64_t last = static_cast<int64_t>((firstOutput + count - 1) * down / up) + 1; // Exclusive
+    switch (mode)
+    {
+    case ResampleMode::LINEAR:
+        last += 1;
+        break;
+    case ResampleMode::POLYPHASE:
+        first -= tapCount / 2 - 1;
+        last += tapCount / 2 + 1; // Including a rounded phase moving to the next sample
+        break;
+    default:
+        break;
+    }
+    int64_t end = static_cast<int64_t>(sampleCount);
+    return {static_cast<uint64_t>(std::clamp<int64_t>(first, 0, end - 1)), static_cast<uint64_t>(std::clamp<int64_t>(last, 1, end))};
+}
+
+void Resampler::resample(const double *source, uint64_t firstOutput, uint64_t count, double *output) const
+{
+    if (sampleCount == 0)
+    {
+        std::fill(output, output + count, std::numeric_limits<double>::quiet_NaN());
+        return;
+    }
+    int64_t sourceFirst = static_cast<int64_t>(getSourceRange(firstOutput, count).first);
+    int64_t lastSample = static_cast<int64_t>(sampleCount) - 1;
+    auto at = [&](int64_t sample)
+    {
+        return source[std::clamp<int64_t>(sample, 0, lastSample) - sourceFirst];
+    };
+
+    switch (mode)
+    {
+    case ResampleMode::HOLD:
+        for (uint64_t i = 0; i < count; i++)
+        {
+            output[i] = at(static_cast<int64_t>((firstOutput + i) * down / up));
+        }
+        break;
+    case ResampleMode::LINEAR:
+        for (uint64_t i = 0; i < count; i++)
+        {
+            uint64_t position = (firstOutput + i) * down;
+            int64_t sample = static_cast<int64_t>(position / up);
+            uint64_t remainder = position % up;
+            double value = at(sample);
+            output[i] = remainder == 0 ? value : value + (at(sample + 1) - value) * (static_cast<double>(remainder) / up);
+        }
+        break;
+    case ResampleMode::POLYPHASE:
+        for (uint64_t i = 0; i < count; i++)
+        {
+            std::pair<uint64_t, uint32_t> filterPosition = getFilterPosition(firstOutput + i);
+            const double *filter = filters.data() + static_cast<size_t>(filterPosition.second) * tapCount;
+            int64_t first = static_cast<int64_t>(filterPosition.first) - (tapCount / 2 - 1);
+            if (first >= 0 && first + tapCount - 1 <= lastSample)
+            {
+                output[i] = dot(source + (first - sourceFirst), filter, tapCount);
+            }
+            else // Near the ends of the channel
+            {
+                double sum = 0;
+                for (int k = 0; k < tapCount; k++)
+                {
+                    sum += at(first + k) * filter[k];
+                }
+                output[i] = sum;
+            }
+        }
+        break;
+    }
+}
@@ -0,0 +1,540 @@
+#include "SampleDecoder.h"
+#include <limits>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SAMPLEDECODER_X86 // SSE2 is part of the x86-64 baseline, AVX2 is detected at runtime
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace
+{
+    const double missingValue = std::numeric_limits<double>::quiet_NaN();
+    const int16_t missingSample = -32768; // INT_16_S value marking missing data
+
+    // Scalar kernels, also used for the tails of the vector kernels
+
+    template <typename T, ByteOrder order>
+    void decodeScalar(const uint8_t *source, size_t count, double *output)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            output[i] = static_cast<double>(loadValue<T>(source + i * sizeof(T), order));
+        }
+    }
+
+    template <ByteOrder order>
+    void decodeInt16Scalar(const uint8_t *source, size_t count, double *output)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            int16_t value = loadValue<int16_t>(source + i * sizeof(int16_t), order);
+            output[i] = value == missingSample ? missingValue : static_cast<double>(value);
+        }
+    }
+
+    template <ByteOrder order>
+    void decodeWithScalar(const uint8_t *source, size_t count, DataType dataType, double *output)
+    {
+        switch (dataType)
+        {
+        case DataType::INT_16_S:
+            return decodeInt16Scalar<order>(source, count, output);
+        case DataType::INT_16_U:
+        case DataType::STATUS_16:
+            return decodeScalar<uint16_t, order>(source, count, output);
+        case DataType::INT_32_S:
+            return decodeScalar<int32_t, order>(source, count, output);
+        case DataType::INT_8_U:
+        case DataType::AHA_8:
+            return decodeScalar<uint8_t, order>(source, count, output);
+        case DataType::INT_8_S:
+            return decodeScalar<int8_t, order>(source, count, output);
+        case DataType::INT_32_U:
+            return decodeScalar<uint32_t, order>(source, count, output);
+        case DataType::FLOAT_32:
+            return decodeScalar<float, order>(source, count, output);
+        case DataType::FLOAT_64:
+            return decodeScalar<double, order>(source, count, output);
+        default:
+            throw std::runtime_error("Invalid data type");
+        }
+    }
+
+    void decodeWithScalar(const uint8_t *source, size_t count, DataType dataType, ByteOrder byteOrder, double *output)
+    {
+        if (byteOrder == ByteOrder::ENDIAN_BIG)
+        {
+            decodeWithScalar<ByteOrder::ENDIAN_BIG>(source, count, dataType, output);
+        }
+        else
+        {
+            decodeWithScalar<ByteOrder::ENDIAN_LITTLE>(source, count, dataType, output);
+        }
+    }
+
+#ifdef SAMPLEDECODER_X86
+
+    // SSE2 kernels
+
+    inline __m128i swap16(__m128i x)
+    {
+        return _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+    }
+
+    inline __m128i swap32(__m128i x)
+    {
+        x = swap16(x);
+        return _mm_or_si128(_mm_slli_epi32(x, 16), _mm_srli_epi32(x, 16));
+    }
+
+    inline __m128i swap64(__m128i x)
+    {
+        return _mm_shuffle_epi32(swap32(x), _MM_SHUFFLE(2, 3, 0, 1));
+    }
+
+    // Converts four 32 bit integers to doubles
+    inline void storeInt32(double *output, __m128i values)
+    {
+        _mm_storeu_pd(output, _mm_cvtepi32_pd(values));
+        _mm_storeu_pd(output + 2, _mm_cvtepi32_pd(_mm_shuffle_epi32(values, _MM_SHUFFLE(1, 0, 3, 2))));
+    }
+
+    // Replaces doubles with NaN where the mask is set
+    inline __m128d maskMissing(__m128d values, __m128i mask)
+    {
+        __m128d maskDouble = _mm_castsi128_pd(mask);
+        return _mm_or_pd(_mm_andnot_pd(maskDouble, values), _mm_and_pd(maskDouble, _mm_set1_pd(missingValue)));
+    }
+
+    template <bool swap, bool isSigned>
+    void decodeInt16SSE2(const uint8_t *source, size_t count, double *output)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i sentinel = _mm_set1_epi16(missingSample);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i * 2));
+            if (swap)
+            {
+                x = swap16(x);
+            }
+            __m128i low = isSigned ? _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16) : _mm_unpacklo_epi16(x, zero);
+            __m128i high = isSigned ? _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16) : _mm_unpackhi_epi16(x, zero);
+            __m128d d0 = _mm_cvtepi32_pd(low);
+            __m128d d1 = _mm_cvtepi32_pd(_mm_shuffle_epi32(low, _MM_SHUFFLE(1, 0, 3, 2)));
+            __m128d d2 = _mm_cvtepi32_pd(high);
+            __m128d d3 = _mm_cvtepi32_pd(_mm_shuffle_epi32(high, _MM_SHUFFLE(1, 0, 3, 2)));
+            if (isSigned)
+            {
+                __m128i missing = _mm_cmpeq_epi16(x, sentinel);
+                if (_mm_movemask_epi8(missing) != 0)
+                {
+                    __m128i missingLow = _mm_unpacklo_epi16(missing, missing);
+                    __m128i missingHigh = _mm_unpackhi_epi16(missing, missing);
+                    d0 = maskMissing(d0, _mm_unpacklo_epi32(missingLow, missingLow));
+                    d1 = maskMissing(d1, _mm_unpackhi_epi32(missingLow, missingLow));
+                    d2 = maskMissing(d2, _mm_unpacklo_epi32(missingHigh, missingHigh));
+                    d3 = maskMissing(d3, _mm_unpackhi_epi32(missingHigh, missingHigh));
+                }
+            }
+            _mm_storeu_pd(output + i, d0);
+            _mm_storeu_pd(output + i + 2, d1);
+            _mm_storeu_pd(output + i + 4, d2);
+            _mm_storeu_pd(output + i + 6, d3);
+        }
+        constexpr ByteOrder order = swap ? ByteOrder::ENDIAN_BIG : ByteOrder::ENDIAN_LITTLE;
+        if (isSigned)
+        {
+            decodeInt16Scalar<order>(source + i * 2, count - i, output + i);
+        }
+        else
+        {
+            decodeScalar<uint16_t, order>(source + i * 2, count - i, output + i);
+        }
+    }
+
+    template <bool isSigned>
+    void decodeInt8SSE2(const uint8_t *source, size_t count, double *output)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i));
+            __m128i words[2];
+            words[0] = isSigned ? _mm_srai_epi16(_mm_unpacklo_epi8(x, x), 8) : _mm_unpacklo_epi8(x, zero);
+            words[1] = isSigned ? _mm_srai_epi16(_mm_unpackhi_epi8(x, x), 8) : _mm_unpackhi_epi8(x, zero);
+            for (int j = 0; j < 2; j++)
+            {
+                __m128i low = isSigned ? _mm_srai_epi32(_mm_unpacklo_epi16(words[j], words[j]), 16) : _mm_unpacklo_epi16(words[j], zero);
+                __m128i high = isSigned ? _mm_srai_epi32(_mm_unpackhi_epi16(words[j], words[j]), 16) : _mm_unpackhi_epi16(words[j], zero);
+                storeInt32(output + i + j * 8, low);
+                storeInt32(output + i + j * 8 + 4, high);
+            }
+        }
+        if (isSigned)
+        {
+            decodeScalar<int8_t, ByteOrder::ENDIAN_LITTLE>(source + i, count - i, output + i);
+        }
+        else
+        {
+            decodeScalar<uint8_t, ByteOrder::ENDIAN_LITTLE>(source + i, count - i, output + i);
+        }
+    }
+
+    template <bool swap, bool isSigned>
+    void decodeInt32SSE2(const uint8_t *source, size_t count, double *output)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i * 4));
+            if (swap)
+            {
+                x = swap32(x);
+            }
+            if (isSigned)
+            {
+                storeInt32(output + i, x);
+            }
+            else
+            {
+                // Offset into the signed range for conversion, then back
+                x = _mm_xor_si128(x, _mm_set1_epi32(static_cast<int32_t>(0x80000000u)));
+                const __m128d offset = _mm_set1_pd(2147483648.0);
+                _mm_storeu_pd(output + i, _mm_add_pd(_mm_cvtepi32_pd(x), offset));
+                _mm_storeu_pd(output + i + 2, _mm_add_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2))), offset));
+            }
+        }
+        constexpr ByteOrder order = swap ? ByteOrder::ENDIAN_BIG : ByteOrder::ENDIAN_LITTLE;
+        if (isSigned)
+        {
+            decodeScalar<int32_t, order>(source + i * 4, count - i, output + i);
+        }
+        else
+        {
+            decodeScalar<uint32_t, order>(source + i * 4, count - i, output + i);
+        }
+    }
+
+    template <bool swap>
+    void decodeFloat32SSE2(const uint8_t *source, size_t count, double *output)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i * 4));
+            if (swap)
+            {
+                x = swap32(x);
+            }
+            __m128 values = _mm_castsi128_ps(x);
+            _mm_storeu_pd(output + i, _mm_cvtps_pd(values));
+            _mm_storeu_pd(output + i + 2, _mm_cvtps_pd(_mm_movehl_ps(values, values)));
+        }
+        decodeScalar<float, swap ? ByteOrder::ENDIAN_BIG : ByteOrder::ENDIAN_LITTLE>(source + i * 4, count - i, output + i);
+    }
+
+    template <bool swap>
+    void decodeFloat64SSE2(const uint8_t *source, size_t count, double *output)
+    {
+        size_t i = 0;
+        for (; i + 2 <= count; i += 2)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i * 8));
+            if (swap)
+            {
+                x = swap64(x);
+            }
+            _mm_storeu_pd(output + i, _mm_castsi128_pd(x));
+        }
+        decodeScalar<double, swap ? ByteOrder::ENDIAN_BIG : ByteOrder::ENDIAN_LITTLE>(source + i * 8, count - i, output + i);
+    }
+
+    template <bool swap>
+    void decodeWithSSE2(const uint8_t *source, size_t count, DataType dataType, double *output)
+    {
+        switch (dataType)
+        {
+        case DataType::INT_16_S:
+            return decodeInt16SSE2<swap, true>(source, count, output);
+        case DataType::INT_16_U:
+        case DataType::STATUS_16:
+            return decodeInt16SSE2<swap, false>(source, count, output);
+        case DataType::INT_32_S:
+            return decodeInt32SSE2<swap, true>(source, count, output);
+        case DataType::INT_32_U:
+            return decodeInt32SSE2<swap, false>(source, count, output);
+        case DataType::INT_8_U:
+        case DataType::AHA_8:
+            return decodeInt8SSE2<false>(source, count, output);
+        case DataType::INT_8_S:
+            return decodeInt8SSE2<true>(source, count, output);
+        case DataType::FLOAT_32:
+            return decodeFloat32SSE2<swap>(source, count, output);
+        case DataType::FLOAT_64:
+            return decodeFloat64SSE2<swap>(source, count, output);
+        default:
+            throw std::runtime_error("Invalid data type");
+        }
+    }
+
+    // AVX2 kernels
+
+    TARGET_AVX2 inline __m128i swapBytes128(__m128i x, int width)
+    {
+        const __m128i swap16Mask = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+        const __m128i swap32Mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+        return _mm_shuffle_epi8(x, width == 2 ? swap16Mask : swap32Mask);
+    }
+
+    template <bool swap, bool isSigned>
+    TARGET_AVX2 void decodeInt16AVX2(const uint8_t *source, size_t count, double *output)
+    {
+        const __m128i sentinel = _mm_set1_epi16(missingSample);
+        const __m256d missing = _mm256_set1_pd(missingValue);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i * 2));
+            if (swap)
+            {
+                x = swapBytes128(x, 2);
+            }
+            __m256i values = isSigned ? _mm256_cvtepi16_epi32(x) : _mm256_cvtepu16_epi32(x);
+            __m256d low = _mm256_cvtepi32_pd(_mm256_castsi256_si128(values));
+            __m256d high = _mm256_cvtepi32_pd(_mm256_extracti128_si256(values, 1));
+            if (isSigned)
+            {
+                __m128i mask = _mm_cmpeq_epi16(x, sentinel);
+                if (_mm_movemask_epi8(mask) != 0)
+                {
+                    low = _mm256_blendv_pd(low, missing, _mm256_castsi256_pd(_mm256_cvtepi16_epi64(mask)));
+                    high = _mm256_blendv_pd(high, missing, _mm256_castsi256_pd(_mm256_cvtepi16_epi64(_mm_srli_si128(mask, 8))));
+                }
+            }
+            _mm256_storeu_pd(output + i, low);
+            _mm256_storeu_pd(output + i + 4, high);
+        }
+        constexpr ByteOrder order = swap ? ByteOrder::ENDIAN_BIG : ByteOrder::ENDIAN_LITTLE;
+        if (isSigned)
+        {
+            decodeInt16Scalar<order>(source + i * 2, count - i, output + i);
+        }
+        else
+        {
+            decodeScalar<uint16_t, order>(source + i * 2, count - i, output + i);
+        }
+    }
+
+    template <bool isSigned>
+    TARGET_AVX2 void decodeInt8AVX2(const uint8_t *source, size_t count, double *output)
+    {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i x = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(source + i));
+            __m256i values = isSigned ? _mm256_cvtepi8_epi32(x) : _mm256_cvtepu8_epi32(x);
+            _mm256_storeu_pd(output + i, _mm256_cvtepi32_pd(_mm256_castsi256_si128(values)));
+            _mm256_storeu_pd(output + i + 4, _mm256_cvtepi32_pd(_mm256_extracti128_si256(values, 1)));
+        }
+        if (isSigned)
+        {
+            decodeScalar<int8_t, ByteOrder::ENDIAN_LITTLE>(source + i, count - i, output + i);
+        }
+        else
+        {
+            decodeScalar<uint8_t, ByteOrder::ENDIAN_LITTLE>(source + i, count - i, output + i);
+        }
+    }
+
+    template <bool swap, bool isSigned>
+    TARGET_AVX2 void decodeInt32AVX2(const uint8_t *source, size_t count, double *output)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i * 4));
+            if (swap)
+            {
+                x = swapBytes128(x, 4);
+            }
+            if (isSigned)
+            {
+                _mm256_storeu_pd(output + i, _mm256_cvtepi32_pd(x));
+            }
+            else
+            {
+                // Offset into the signed range for conversion, then back
+                x = _mm_xor_si128(x, _mm_set1_epi32(static_cast<int32_t>(0x80000000u)));
+                _mm256_storeu_pd(output + i, _mm256_add_pd(_mm256_cvtepi32_pd(x), _mm256_set1_pd(2147483648.0)));
+            }
+        }
+        constexpr ByteOrder order = swap ? ByteOrder::ENDIAN_BIG : ByteOrder::ENDIAN_LITTLE;
+        if (isSigned)
+        {
+            decodeScalar<int32_t, order>(source + i * 4, count - i, output + i);
+        }
+        else
+        {
+            decodeScalar<uint32_t, order>(source + i * 4, count - i, output + i);
+        }
+    }
+
+    template <bool swap>
+    TARGET_AVX2 void decodeFloat32AVX2(const uint8_t *source, size_t count, double *output)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i * 4));
+            if (swap)
+            {
+                x = swapBytes128(x, 4);
+            }
+            _mm256_storeu_pd(output + i, _mm256_cvtps_pd(_mm_castsi128_ps(x)));
+        }
+        decodeScalar<float, swap ? ByteOrder::ENDIAN_BIG : ByteOrder::ENDIAN_LITTLE>(source + i * 4, count - i, output + i);
+    }
+
+    template <bool swap>
+    TARGET_AVX2 void decodeFloat64AVX2(const uint8_t *source, size_t count, double *output)
+    {
+        const __m256i swap64Mask = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                                                    7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(source + i * 8));
+            if (swap)
+            {
+                x = _mm256_shuffle_epi8(x, swap64Mask);
+            }
+            _mm256_storeu_pd(output + i, _mm256_castsi256_pd(x));
+        }
+        decodeScalar<double, swap ? ByteOrder::ENDIAN_BIG : ByteOrder::ENDIAN_LITTLE>(source + i * 8, count - i, output + i);
+    }
+
+    template <bool swap>
+    void decodeWithAVX2(const uint8_t *source, size_t count, DataType dataType, double *output)
+    {
+        switch (dataType)
+        {
+        case DataType::INT_16_S:
+            return decodeInt16AVX2<swap, true>(source, count, output);
+        case DataType::INT_16_U:
+        case DataType::STATUS_16:
+            return decodeInt16AVX2<swap, false>(source, count, output);
+        case DataType::INT_32_S:
+            return decodeInt32AVX2<swap, true>(source, count, output);
+        case DataType::INT_32_U:
+            return decodeInt32AVX2<swap, false>(source, count, output);
+        case DataType::INT_8_U:
+        case DataType::AHA_8:
+            return decodeInt8AVX2<false>(source, count, output);
+        case DataType::INT_8_S:
+            return decodeInt8AVX2<true>(source, count, output);
+        case DataType::FLOAT_32:
+            return decodeFloat32AVX2<swap>(source, count, output);
+        case DataType::FLOAT_64:
+            return decodeFloat64AVX2<swap>(source, count, output);
+        default:
+            throw std::runtime_error("Invalid data type");
+        }
+    }
+
+    bool cpuSupportsAVX2()
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+        {
+            return false;
+        }
+        __cpuid(info, 1);
+        bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6; // OSXSAVE, and XMM and YMM state enabled
+        __cpuidex(info, 7, 0);
+        return osSavesYmm && (info[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+
+#endif // SAMPLEDECODER_X86
+}
+
+bool isDecodeKernelSupported(DecodeKernel kernel)
+{
+    switch (kernel)
+    {
+    case DecodeKernel::SCALAR:
+        return true;
+#ifdef SAMPLEDECODER_X86
+    case DecodeKernel::SSE2:
+        return true;
+    case DecodeKernel::AVX2:
+    {
+        static const bool supported = cpuSupportsAVX2();
+        return supported;
+    }
+#endif
+    default:
+        return false;
+    }
+}
+
+DecodeKernel getDecodeKernel()
+{
+    static const DecodeKernel kernel = isDecodeKernelSupported(DecodeKernel::AVX2)   ? DecodeKernel::AVX2
+                                       : isDecodeKernelSupported(DecodeKernel::SSE2) ? DecodeKernel::SSE2
+                                                                                     : DecodeKernel::SCALAR;
+    return kernel;
+}
+
+std::string decodeKernelName(DecodeKernel kernel)
+{
+    switch (kernel)
+    {
+    case DecodeKernel::SSE2:
+        return "SSE2";
+    case DecodeKernel::AVX2:
+        return "AVX2";
+    default:
+        return "Scalar";
+    }
+}
+
+void decodeSamples(const uint8_t *source, size_t count, DataType dataType, ByteOrder byteOrder, double *output)
+{
+    decodeSamples(source, count, dataType, byteOrder, output, getDecodeKernel());
+}
+
+void decodeSamples(const uint8_t *source, size_t count, DataType dataType, ByteOrder byteOrder, double *output, DecodeKernel kernel)
+{
+    if (!isDecodeKernelSupported(kernel))
+    {
+        throw std::runtime_error("Decode kernel " + decodeKernelName(kernel) + " is not supported on this CPU");
+    }
+    bool swap = byteOrder == ByteOrder::ENDIAN_BIG;
+    switch (kernel)
+    {
+#ifdef SAMPLEDECODER_X86
+    case DecodeKernel::AVX2:
+        return swap ? decodeWithAVX2<true>(source, count, dataType, output) : decodeWithAVX2<false>(source, count, dataType, output);
+    case DecodeKernel::SSE2:
+        return swap ? decodeWithSSE2<true>(source, count, dataType, output) : decodeWithSSE2<false>(source, count, dataType, output);
+#endif
+    default:
+        return decodeWithScalar(source, count, dataType, byteOrder, output);
+    }
+}
@@ -0,0 +1,98 @@
+#include "SidecarFile.h"
+#include "BinaryWriter.h"
+#include <filesystem>
+#include <stdexcept>
+
+uint64_t hashBytes(ByteView bytes, uint64_t hash)
+{
+    for (uint8_t byte : bytes)
+    {
+        hash = (hash ^ byte) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+SidecarWriter::SidecarWriter(const ByteVector &magic, uint32_t version) : bytes(magic)
+{
+    value<uint32_t>(version);
+}
+
+void SidecarWriter::string(const std::string &text)
+{
+    value<uint32_t>(static_cast<uint32_t>(text.size()));
+    bytes.insert(bytes.end(), text.begin(), text.end());
+}
+
+ByteVector SidecarWriter::finish()
+{
+    value<uint64_t>(hashBytes(bytes)); // Checksum of everything before it
+    return std::move(bytes);
+}
+
+namespace
+{
+    ByteView checkedBody(ByteView bytes, const ByteVector &magic, const std::string &name)
+    {
+        if (bytes.size() < magic.size() + sizeof(uint64_t) || bytes.subview(0, magic.size()) != ByteView(magic))
+        {
+            throw std::runtime_error("Not a " + name + ".");
+        }
+        ByteView body = bytes.subview(0, bytes.size() - sizeof(uint64_t));
+        if (hashBytes(body) != loadValue<uint64_t>(body.end(), ByteOrder::ENDIAN_LITTLE))
+        {
+            throw std::runtime_error("The " + name + " checksum does not match.");
+        }
+        return body.subview(magic.size(), body.size() - magic.size());
+    }
+}
+
+SidecarReader::SidecarReader(ByteView bytes, const ByteVector &magic, uint32_t version, const std::string &name)
+    : name(name), dataStack(checkedBody(bytes, magic, name))
+{
+    if (value<uint32_t>() != version)
+    {
+        throw std::runtime_error("Unsupported " + name + " version.");
+    }
+}
+
+std::string SidecarReader::string()
+{
+    ByteView text = dataStack.pop_front(value<uint32_t>());
+    return std::string(text.begin(), text.end());
+}
+
+uint32_t SidecarReader::count(size_t minimumSize)
+{
+    uint32_t count = value<uint32_t>();
+    if (static_cast<uint64_t>(count) * minimumSize > dataStack.size())
+    {
+        throw std::runtime_error("The " + name + " holds a list longer than itself.");
+    }
+    return count;
+}
+
+void SidecarReader::finish()
+{
+    if (dataStack.size() != 0)
+    {
+        throw std::runtime_error("Unexpected data after the " + name + ".");
+    }
+}
+
+void writeSidecarFile(const std::string &fileName, ByteView bytes)
+{
+    std::string temporaryFileName = fileName + ".part";
+    try
+    {
+        BinaryWriter file(temporaryFileName);
+        file.write(bytes);
+        file.close();
+        std::filesystem::rename(temporaryFileName, fileName);
+    }
+    catch (...)
+    {
+        std::error_code error;
+        std::filesystem::remove(temporaryFileName, error);
+        throw;
+    }
+}
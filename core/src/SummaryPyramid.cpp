@@ -0,0 +1,391 @@
+#include "SummaryPyramid.h"
+#include "FileManager.h"
+#include "SidecarFile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+    const ByteVector magic = {'M', 'O', 'N', 'K', 'S', 'U', 'M', 0x00};
+    constexpr float missing = std::numeric_limits<float>::quiet_NaN();
+
+    void checkOptions(const SummaryOptions &options)
+    {
+        if (options.baseBinLength == 0 || options.levelFactor < 2)
+        {
+            throw std::runtime_error("Base bin length must be at least 1 and level factor at least 2");
+        }
+    }
+
+    // Levels until the first with a single bin
+    size_t countLevels(uint64_t sampleCount, const SummaryOptions &options)
+    {
+        size_t count = 0;
+        for (uint64_t binLength = options.baseBinLength; sampleCount > 0; binLength *= options.levelFactor)
+        {
+            count++;
+            if (binLength >= sampleCount)
+            {
+                break;
+            }
+        }
+        return count;
+    }
+
+    // Sampling intervals are read as floats, such as 0.0040000002 for 4 ms, which puts times that fall on samples
+    // far into a recording a sample off. The decimal the float was rounded from is exact enough for any recording.
+    double toDecimal(float value)
+    {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%.7g", value);
+        return std::strtod(text, nullptr);
+    }
+
+    uint64_t countBins(uint64_t sampleCount, uint64_t binLength)
+    {
+        return (sampleCount + binLength - 1) / binLength;
+    }
+
+    // Bin of a level being filled, by samples for the first level and by the bins of the level below for the others
+    struct Accumulator
+    {
+        float min = std::numeric_limits<float>::infinity();
+        float max = -std::numeric_limits<float>::infinity();
+        double sum = 0;
+        uint32_t count = 0;  // Samples that are not missing
+        uint64_t length = 0; // Samples or bins taken
+
+        inline void add(double value)
+        {
+            length++;
+            if (!std::isnan(value))
+            {
+                min = std::min(min, static_cast<float>(value));
+                max = std::max(max, static_cast<float>(value));
+                sum += value;
+                count++;
+            }
+        }
+
+        inline void add(const SummaryBin &bin)
+        {
+            length++;
+            if (bin.count > 0)
+            {
+                min = std::min(min, bin.min);
+                max = std::max(max, bin.max);
+                sum += static_cast<double>(bin.mean) * bin.count;
+                count += bin.count;
+            }
+        }
+
+        inline SummaryBin take()
+        {
+            SummaryBin bin = count == 0 ? SummaryBin{missing, missing, missing, 0}
+                                        : SummaryBin{min, max, static_cast<float>(sum / count), count};
+            *this = Accumulator();
+            return bin;
+        }
+    };
+
+    class ChannelBuilder
+    {
+    public:
+        ChannelBuilder(std::vector<std::vector<SummaryBin>> &levels, uint64_t sampleCount, const SummaryOptions &options)
+            : levels(levels), accumulators(countLevels(sampleCount, options)), options(options)
+        {
+            levels.resize(accumulators.size());
+            uint64_t binLength = options.baseBinLength;
+            for (auto &level : levels)
+            {
+                level.reserve(countBins(sampleCount, binLength));
+                binLength *= options.levelFactor;
+            }
+        }
+
+        void add(const double *samples, size_t count)
+        {
+            Accumulator &first = accumulators[0];
+            for (size_t i = 0; i < count; i++)
+            {
+                first.add(samples[i]);
+                if (first.length == options.baseBinLength)
+                {
+                    emit(0);
+                }
+            }
+        }
+
+        void finish() // Emits the partial bins at the end of the channel
+        {
+            for (size_t level = 0; level < accumulators.size(); level++)
+            {
+                if (accumulators[level].length > 0)
+                {
+                    emit(level);
+                }
+            }
+        }
+
+    private:
+        std::vector<std::vector<SummaryBin>> &levels;
+        std::vector<Accumulator> accumulators;
+        const SummaryOptions &options;
+
+        void emit(size_t level)
+        {
+            for (; level < accumulators.size(); level++)
+            {
+                SummaryBin bin = accumulators[level].take();
+                levels[level].push_back(bin);
+                if (level + 1 == accumulators.size())
+                {
+                    return;
+                }
+                accumulators[level + 1].add(bin);
+                if (accumulators[level + 1].length < options.levelFactor)
+                {
+                    return;
+                }
+            }
+        }
+    };
+}
+
+SummaryPyramid::SummaryPyramid(const NihonKohdenData &data, const SummaryOptions &options) : options(options)
+{
+    checkOptions(options);
+    if (data.hasSourceFile())
+    {
+        fingerprint = data.getFingerprint();
+    }
+    const Header &header = data.getMetadata();
+    std::vector<ChannelBuilder> builders;
+    channels.resize(header.channels.size());
+    builders.reserve(channels.size());
+    uint32_t largestBlockLength = 0;
+    for (size_t i = 0; i < channels.size(); i++)
+    {
+        channels[i].samplingInterval = toDecimal(header.channels[i].samplingInterval);
+        channels[i].sampleCount = data.getSampleCount(i);
+        builders.emplace_back(channels[i].levels, channels[i].sampleCount, this->options);
+        largestBlockLength = std::max(largestBlockLength, header.channels[i].blockLength);
+    }
+
+    // Sequences in file order, so the waveform is read once from start to end
+    std::vector<double> samples(largestBlockLength);
+    for (uint64_t sequence = 0; sequence < header.sequenceCount; sequence++)
+    {
+        for (size_t i = 0; i < channels.size(); i++)
+        {
+            uint32_t blockLength = header.channels[i].blockLength;
+            if (channels[i].sampleCount > 0 && blockLength > 0)
+            {
+                data.readSamples(i, sequence * blockLength, blockLength, samples.data());
+                builders[i].add(samples.data(), blockLength);
+            }
+        }
+    }
+    for (ChannelBuilder &builder : builders)
+    {
+        builder.finish();
+    }
+}
+
+const SummaryPyramid::ChannelSummary &SummaryPyramid::getChannel(size_t channel) const
+{
+    if (channel >= channels.size())
+    {
+        throw std::runtime_error("Channel index out of range");
+    }
+    return channels[channel];
+}
+
+size_t SummaryPyramid::getLevelCount(size_t channel) const
+{
+    return getChannel(channel).levels.size();
+}
+
+uint64_t SummaryPyramid::getBinLength(size_t level) const
+{
+    uint64_t binLength = 1;
+    for (size_t i = 0; i < level; i++)
+    {
+        binLength *= i == 0 ? options.baseBinLength : options.levelFactor;
+    }
+    return binLength;
+}
+
+const std::vector<SummaryBin> &SummaryPyramid::getLevel(size_t channel, size_t level) const
+{
+    const ChannelSummary &summary = getChannel(channel);
+    if (level == 0 || level > summary.levels.size())
+    {
+        throw std::runtime_error("Summary level out of range");
+    }
+    return summary.levels[level - 1];
+}
+
+bool SummaryPyramid::matches(const NihonKohdenData &data) const
+{
+    if (data.getMetadata().channels.size() != channels.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < channels.size(); i++)
+    {
+        if (data.getSampleCount(i) != channels[i].sampleCount)
+        {
+            return false;
+        }
+    }
+    return fingerprint == (data.hasSourceFile() ? data.getFingerprint() : FileFingerprint());
+}
+
+SummaryRange SummaryPyramid::query(size_t channel, double start, double end, uint32_t pixels, const NihonKohdenData *data) const
+{
+    const ChannelSummary &summary = getChannel(channel);
+    if (start < 0 || end < start || pixels == 0)
+    {
+        throw std::runtime_error("Query needs 0 <= start <= end and at least one pixel");
+    }
+    if (data != nullptr && !matches(*data))
+    {
+        throw std::runtime_error("Data does not match the summary");
+    }
+    SummaryRange range;
+    if (summary.levels.empty() || summary.samplingInterval <= 0)
+    {
+        return range;
+    }
+
+    // Times within a millionth of a sample of a sample are taken as on it, against the rounding of the division
+    double sampleCount = static_cast<double>(summary.sampleCount);
+    uint64_t first = static_cast<uint64_t>(std::min(std::floor(start / summary.samplingInterval + 1e-6), sampleCount));
+    uint64_t last = static_cast<uint64_t>(std::min(std::ceil(end / summary.samplingInterval - 1e-6), sampleCount)); // Exclusive
+    double samplesPerPixel = static_cast<double>(last - first) / pixels;
+
+    uint32_t level = 0;
+    while (level < summary.levels.size() && getBinLength(level + 1) <= samplesPerPixel)
+    {
+        level++;
+    }
+    if (level == 0 && data == nullptr)
+    {
+        level = 1;
+    }
+
+    range.level = level;
+    range.binLength = getBinLength(level);
+    range.binDuration = range.binLength * summary.samplingInterval;
+    if (level == 0)
+    {
+        std::vector<double> samples(last - first);
+        data->readSamples(channel, first, samples.size(), samples.data());
+        range.bins.reserve(samples.size());
+        for (double sample : samples)
+        {
+            float value = static_cast<float>(sample);
+            range.bins.push_back(std::isnan(sample) ? SummaryBin{missing, missing, missing, 0} : SummaryBin{value, value, value, 1});
+        }
+        range.firstBin = first;
+    }
+    else
+    {
+        const std::vector<SummaryBin> &bins = summary.levels[level - 1];
+        range.firstBin = first / range.binLength;
+        uint64_t lastBin = std::max(countBins(last, range.binLength), range.firstBin);
+        range.bins.assign(bins.begin() + range.firstBin, bins.begin() + lastBin);
+    }
+    range.start = range.firstBin * range.binDuration;
+    return range;
+}
+
+ByteVector SummaryPyramid::serialize() const
+{
+    SidecarWriter writer(magic, version);
+    writer.value<uint32_t>(options.baseBinLength);
+    writer.value<uint32_t>(options.levelFactor);
+    writer.value<uint64_t>(fingerprint.size);
+    writer.value<int64_t>(fingerprint.modificationTime);
+    writer.value<uint64_t>(fingerprint.headerHash);
+    writer.value<uint32_t>(static_cast<uint32_t>(channels.size()));
+    for (const ChannelSummary &summary : channels)
+    {
+        writer.value<double>(summary.samplingInterval);
+        writer.value<uint64_t>(summary.sampleCount);
+        writer.value<uint32_t>(static_cast<uint32_t>(summary.levels.size()));
+        for (const auto &level : summary.levels)
+        {
+            writer.value<uint32_t>(static_cast<uint32_t>(level.size()));
+            for (const SummaryBin &bin : level)
+            {
+                writer.value<float>(bin.min);
+                writer.value<float>(bin.max);
+                writer.value<float>(bin.mean);
+                writer.value<uint32_t>(bin.count);
+            }
+        }
+    }
+    return writer.finish();
+}
+
+SummaryPyramid SummaryPyramid::parse(ByteView bytes)
+{
+    SidecarReader reader(bytes, magic, version, "summary pyramid");
+    SummaryPyramid pyramid;
+    pyramid.options.baseBinLength = reader.value<uint32_t>();
+    pyramid.options.levelFactor = reader.value<uint32_t>();
+    checkOptions(pyramid.options);
+    pyramid.fingerprint.size = reader.value<uint64_t>();
+    pyramid.fingerprint.modificationTime = reader.value<int64_t>();
+    pyramid.fingerprint.headerHash = reader.value<uint64_t>();
+    pyramid.channels.resize(reader.count(sizeof(double) + sizeof(uint64_t) + sizeof(uint32_t)));
+    for (ChannelSummary &summary : pyramid.channels)
+    {
+        summary.samplingInterval = reader.value<double>();
+        summary.sampleCount = reader.value<uint64_t>();
+        summary.levels.resize(reader.count(sizeof(uint32_t)));
+        if (summary.levels.size() != countLevels(summary.sampleCount, pyramid.options))
+        {
+            throw std::runtime_error("Summary pyramid levels do not match the sample count.");
+        }
+        for (size_t i = 0; i < summary.levels.size(); i++)
+        {
+            auto &level = summary.levels[i];
+            level.resize(reader.count(sizeof(SummaryBin)));
+            if (level.size() != countBins(summary.sampleCount, pyramid.getBinLength(i + 1)))
+            {
+                throw std::runtime_error("Summary pyramid bins do not match the sample count.");
+            }
+            for (SummaryBin &bin : level)
+            {
+                bin.min = reader.value<float>();
+                bin.max = reader.value<float>();
+                bin.mean = reader.value<float>();
+                bin.count = reader.value<uint32_t>();
+            }
+        }
+    }
+    reader.finish();
+    return pyramid;
+}
+
+void SummaryPyramid::write(const std::string &fileName) const
+{
+    writeSidecarFile(fileName, serialize());
+}
+
+SummaryPyramid SummaryPyramid::read(const std::string &fileName, const NihonKohdenData &data)
+{
+    SummaryPyramid pyramid = parse(FileManager::readBinaryFile(fileName));
+    if (!pyramid.matches(data))
+    {
+        throw std::runtime_error("Summary pyramid does not match the recording.");
+    }
+    return pyramid;
+}
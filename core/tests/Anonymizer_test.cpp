@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include "Anonymizer.h"
+#include "MFERGenerator.h"
+#include "NihonKohdenData.h"
+#include "FileManager.h"
+#include <filesystem>
+
+// Expected result, anonymizing the parsed file and writing it back to expectedFileName
+ByteVector anonymizedBytes(const std::string &fileName, const std::string &expectedFileName)
+{
+    NihonKohdenData nkData(fileName);
+    nkData.anonymize();
+    nkData.writeToBinary(expectedFileName);
+    return FileManager::readBinaryFile(expectedFileName);
+}
+
+// Test that only the identifying fields are patched
+TEST(AnonymizerTest, FindPatches)
+{
+    ByteVector file = FileManager::readBinaryFile("test-file.MWF");
+    std::vector<FilePatch> patches = findAnonymizationPatches(file);
+    ASSERT_EQ(patches.size(), 2); // Patient ID and name, AGE and SEX are already anonymized in the test file
+    for (const FilePatch &patch : patches)
+    {
+        EXPECT_LT(patch.offset + patch.bytes.size(), 300); // Within the header
+    }
+    EXPECT_EQ(patches[0].bytes, ByteVector(17, 0x00)); // Patient ID
+}
+
+// Test that anonymizing in place gives the same file as anonymize and writeToBinary
+TEST(AnonymizerTest, AnonymizeInPlace)
+{
+    std::filesystem::copy_file("test-file.MWF", "output-inplace.MWF", std::filesystem::copy_options::overwrite_existing);
+    anonymizeFile("output-inplace.MWF");
+    ByteVector expected = anonymizedBytes("test-file.MWF", "output-inplace-expected.MWF");
+    EXPECT_EQ(FileManager::readBinaryFile("output-inplace.MWF"), expected);
+    EXPECT_TRUE(findAnonymizationPatches(expected).empty());
+
+    anonymizeFile("output-inplace.MWF"); // Anonymizing twice changes nothing
+    EXPECT_EQ(FileManager::readBinaryFile("output-inplace.MWF"), expected);
+}
+
+// Test that the copy is anonymized and the input left unchanged
+TEST(AnonymizerTest, AnonymizeCopy)
+{
+    ByteVector original = FileManager::readBinaryFile("test-file.MWF");
+    anonymizeFile("test-file.MWF", "output-copy.MWF");
+    EXPECT_EQ(FileManager::readBinaryFile("test-file.MWF"), original);
+    EXPECT_EQ(FileManager::readBinaryFile("output-copy.MWF"), anonymizedBytes("test-file.MWF", "output-copy-expected.MWF"));
+
+    // Big-endian recording with every identifying field set
+    GeneratorOptions options;
+    options.byteOrder = ByteOrder::ENDIAN_BIG;
+    options.sequenceCount = 2;
+    options.eventCount = 1;
+    generateMFERFile("output-anonymizer-generated.MWF", options);
+    anonymizeFile("output-anonymizer-generated.MWF", "output-generated-copy.MWF");
+    EXPECT_EQ(FileManager::readBinaryFile("output-generated-copy.MWF"), anonymizedBytes("output-anonymizer-generated.MWF", "output-generated-expected.MWF"));
+
+    EXPECT_THROW(anonymizeFile("missing.MWF", "output-missing.MWF"), std::runtime_error);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
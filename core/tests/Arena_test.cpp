@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include "Arena.h"
+#include <cstring>
+
+// Test that allocations are aligned and share a block
+TEST(ArenaTest, Allocate)
+{
+    Arena arena;
+    EXPECT_EQ(arena.getBlockCount(), 0);
+
+    uint8_t *byte = static_cast<uint8_t *>(arena.allocate(1, 1));
+    double *value = static_cast<double *>(arena.allocate(sizeof(double), alignof(double)));
+    uint64_t *aligned = static_cast<uint64_t *>(arena.allocate(8, 64));
+    *byte = 0xAB;
+    *value = 1.5;
+    *aligned = 42;
+
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(value) % alignof(double), 0);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 64, 0);
+    EXPECT_EQ(*byte, 0xAB);
+    EXPECT_EQ(*value, 1.5);
+    EXPECT_EQ(arena.getBlockCount(), 1);
+}
+
+// Test that a full block is followed by a new one and large allocations get their own
+TEST(ArenaTest, Blocks)
+{
+    Arena arena;
+    for (size_t i = 0; i < Arena::blockSize / 64; i++)
+    {
+        std::memset(arena.allocate(64, 1), 0x11, 64);
+    }
+    EXPECT_EQ(arena.getBlockCount(), 1);
+    arena.allocate(64, 1);
+    EXPECT_EQ(arena.getBlockCount(), 2);
+
+    uint8_t *large = static_cast<uint8_t *>(arena.allocate(Arena::blockSize * 4, 1));
+    std::memset(large, 0x22, Arena::blockSize * 4);
+    EXPECT_EQ(arena.getBlockCount(), 3);
+
+    uint8_t *small = static_cast<uint8_t *>(arena.allocate(16, 1)); // Still fits the current block
+    EXPECT_EQ(arena.getBlockCount(), 3);
+    EXPECT_FALSE(small >= large && small < large + Arena::blockSize * 4);
+}
+
+// Test creating objects and arrays
+TEST(ArenaTest, Create)
+{
+    struct Point
+    {
+        int x;
+        int y;
+        Point(int x, int y) : x(x), y(y) {}
+    };
+
+    Arena arena;
+    Point *point = arena.create<Point>(3, 4);
+    EXPECT_EQ(point->x, 3);
+    EXPECT_EQ(point->y, 4);
+
+    int values[] = {1, 2, 3};
+    ArenaArray<int> array = arena.copyArray(values, 3);
+    ASSERT_EQ(array.size(), 3);
+    values[0] = 10;
+    EXPECT_EQ(array[0], 1);
+    EXPECT_EQ(array[2], 3);
+    EXPECT_TRUE(arena.copyArray<int>(nullptr, 0).empty());
+}
+
+// Test that moving an arena moves its blocks
+TEST(ArenaTest, Move)
+{
+    Arena arena;
+    int *value = arena.create<int>(7);
+    Arena moved = std::move(arena);
+    EXPECT_EQ(arena.getBlockCount(), 0);
+    EXPECT_EQ(moved.getBlockCount(), 1);
+    EXPECT_EQ(*value, 7);
+
+    Arena assigned;
+    assigned.create<int>(1);
+    assigned = std::move(moved);
+    EXPECT_EQ(assigned.getBlockCount(), 1);
+    EXPECT_EQ(*value, 7);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include "ArrowWriter.h"
+#include "FileManager.h"
+#include <cstring>
+
+uint32_t readUint32(const ByteVector &bytes, size_t offset)
+{
+    uint32_t value;
+    memcpy(&value, bytes.data() + offset, sizeof(value));
+    return value;
+}
+
+// Test the framing of an arrow file: magic, schema message, record batch and footer
+TEST(ArrowWriterTest, FileLayout)
+{
+    std::vector<ArrowField> fields = {{"a", ArrowType::INT_16, true, {{"unit", "V"}}}, {"b", ArrowType::FLOAT_64, false, {}}};
+    int16_t a[] = {1, 2, 3};
+    uint8_t validity[] = {0x05}; // Second value is null
+    double b[] = {0.5, 1.5, 2.5};
+    {
+        ArrowWriter file("test-arrowwriter.arrow", fields, {{"key", "value"}});
+        file.writeBatch(3, {{reinterpret_cast<const uint8_t *>(a), validity, 1}, {reinterpret_cast<const uint8_t *>(b)}});
+        file.close();
+    }
+
+    ByteVector bytes = FileManager::readBinaryFile("test-arrowwriter.arrow");
+    ASSERT_GT(bytes.size(), 16);
+    EXPECT_EQ(std::string(bytes.begin(), bytes.begin() + 6), "ARROW1");
+    EXPECT_EQ(std::string(bytes.end() - 6, bytes.end()), "ARROW1");
+    EXPECT_EQ(bytes.size() % 2, 0);
+
+    // Schema message follows the magic, with metadata padded to 8 bytes
+    EXPECT_EQ(readUint32(bytes, 8), 0xFFFFFFFF);
+    uint32_t schemaLength = readUint32(bytes, 12);
+    EXPECT_EQ(schemaLength % 8, 0);
+
+    // Record batch message, its body holds the validity bitmap and values of each column at 8-byte offsets
+    size_t batch = 16 + schemaLength;
+    EXPECT_EQ(readUint32(bytes, batch), 0xFFFFFFFF);
+    uint32_t batchLength = readUint32(bytes, batch + 4);
+    EXPECT_EQ(batchLength % 8, 0);
+    size_t body = batch + 8 + batchLength;
+    EXPECT_EQ(bytes[body], 0x05);
+    EXPECT_EQ(memcmp(bytes.data() + body + 8, a, sizeof(a)), 0);
+    EXPECT_EQ(memcmp(bytes.data() + body + 16, b, sizeof(b)), 0);
+
+    // End of stream marker, then the footer and its length
+    size_t endOfStream = body + 40;
+    EXPECT_EQ(readUint32(bytes, endOfStream), 0xFFFFFFFF);
+    EXPECT_EQ(readUint32(bytes, endOfStream + 4), 0);
+    uint32_t footerLength = readUint32(bytes, bytes.size() - 10);
+    EXPECT_EQ(endOfStream + 8 + footerLength + 10, bytes.size());
+}
+
+// Test that batches not matching the schema are rejected
+TEST(ArrowWriterTest, InvalidBatch)
+{
+    std::vector<ArrowField> fields = {{"a", ArrowType::UINT_8, false, {}}};
+    uint8_t values[] = {1, 2};
+    uint8_t validity[] = {0x01};
+    ArrowWriter file("test-arrowwriter-invalid.arrow", fields);
+
+    EXPECT_THROW(file.writeBatch(2, {}), std::runtime_error);
+    EXPECT_THROW(file.writeBatch(2, {{values, validity, 1}}), std::runtime_error);
+    EXPECT_NO_THROW(file.writeBatch(2, {{values}}));
+    file.close();
+    EXPECT_THROW(file.writeBatch(2, {{values}}), std::runtime_error);
+}
+
+// Test for the size of each arrow type
+TEST(ArrowWriterTest, TypeSize)
+{
+    EXPECT_EQ(getArrowTypeSize(ArrowType::UINT_8), 1);
+    EXPECT_EQ(getArrowTypeSize(ArrowType::INT_16), 2);
+    EXPECT_EQ(getArrowTypeSize(ArrowType::FLOAT_32), 4);
+    EXPECT_EQ(getArrowTypeSize(ArrowType::FLOAT_64), 8);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
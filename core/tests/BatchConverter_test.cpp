@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include "BatchConverter.h"
+#include "NihonKohdenData.h"
+#include "FileManager.h"
+#include <filesystem>
+
+// Test that each file is converted as by a single conversion, and failures are reported per file
+TEST(BatchConverterTest, ConvertMany)
+{
+    std::filesystem::remove_all("batch-output");
+    std::filesystem::create_directories("batch-input");
+    std::filesystem::copy_file("test-file.MWF", "batch-input/copy.MWF", std::filesystem::copy_options::overwrite_existing);
+
+    std::vector<std::string> inputs = {"test-file.MWF", "missing.MWF", "batch-input/copy.MWF", "batch-input/test-file.MWF"};
+    std::vector<ConversionResult> results = convertMany(inputs, "batch-output", OutputFormat::CSV, 2);
+
+    ASSERT_EQ(results.size(), 4);
+    EXPECT_TRUE(results[0].success);
+    EXPECT_EQ(results[0].input, "test-file.MWF");
+    EXPECT_EQ(std::filesystem::path(results[0].output), std::filesystem::path("batch-output/test-file.csv"));
+    EXPECT_FALSE(results[1].success);
+    EXPECT_FALSE(results[1].error.empty());
+    EXPECT_FALSE(std::filesystem::exists("batch-output/missing.csv"));
+    EXPECT_FALSE(std::filesystem::exists("batch-output/missing.csv.part"));
+    EXPECT_TRUE(results[2].success);
+    EXPECT_FALSE(results[3].success); // Same output name as the first input
+    EXPECT_EQ(results[3].error, "Output file name is used by another input");
+
+    NihonKohdenData nkData("test-file.MWF");
+    nkData.writeToCsv("batch-expected.csv");
+    ByteVector expected = FileManager::readBinaryFile("batch-expected.csv");
+    EXPECT_EQ(FileManager::readBinaryFile(results[0].output), expected);
+    EXPECT_EQ(FileManager::readBinaryFile(results[2].output), expected);
+}
+
+// Test that a memory limit smaller than a file still converts every file
+TEST(BatchConverterTest, MemoryLimit)
+{
+    std::filesystem::remove_all("batch-memory-output");
+    std::vector<std::string> inputs = {"test-file.MWF", "batch-memory-input/copy.MWF"};
+    std::filesystem::create_directories("batch-memory-input");
+    std::filesystem::copy_file("test-file.MWF", "batch-memory-input/copy.MWF", std::filesystem::copy_options::overwrite_existing);
+
+    std::vector<ConversionResult> results = convertMany(inputs, "batch-memory-output", OutputFormat::ARROW, 2, 1);
+    ASSERT_EQ(results.size(), 2);
+    EXPECT_TRUE(results[0].success);
+    EXPECT_TRUE(results[1].success);
+    EXPECT_TRUE(std::filesystem::exists("batch-memory-output/copy.arrow"));
+}
+
+// Test for the output format names
+TEST(BatchConverterTest, OutputFormat)
+{
+    EXPECT_EQ(getOutputFormat("csv"), OutputFormat::CSV);
+    EXPECT_EQ(getOutputFormat("arrow"), OutputFormat::ARROW);
+    EXPECT_EQ(getOutputExtension(OutputFormat::ARROW), ".arrow");
+    EXPECT_THROW(getOutputFormat("xml"), std::runtime_error);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include "BinaryWriter.h"
+#include "FileManager.h"
+
+namespace
+{
+    ByteVector patternBytes(size_t size, uint8_t seed)
+    {
+        ByteVector bytes(size);
+        for (size_t i = 0; i < size; i++)
+        {
+            bytes[i] = static_cast<uint8_t>(i * 31 + seed);
+        }
+        return bytes;
+    }
+}
+
+// Test that small writes are gathered and written in order
+TEST(BinaryWriterTest, SmallWrites)
+{
+    {
+        BinaryWriter file("binary-small.bin");
+        file.write(0x40);
+        file.write(ByteVector{0x01, 0x02, 0x03});
+        file.write(ByteVector{});
+        file.close();
+    }
+    EXPECT_EQ(FileManager::readBinaryFile("binary-small.bin"), (ByteVector{0x40, 0x01, 0x02, 0x03}));
+}
+
+// Test that writes larger than the buffer are written in place, after the buffered bytes
+TEST(BinaryWriterTest, MixedWrites)
+{
+    ByteVector expected;
+    {
+        BinaryWriter file("binary-mixed.bin");
+        for (size_t size : {size_t(1), BinaryWriter::bufferSize - 1, size_t(2), BinaryWriter::bufferSize, size_t(3),
+                            BinaryWriter::bufferSize * 3 + 7, BinaryWriter::bufferSize + 1, size_t(5)})
+        {
+            ByteVector bytes = patternBytes(size, static_cast<uint8_t>(size));
+            file.write(bytes);
+            expected.insert(expected.end(), bytes.begin(), bytes.end());
+        }
+        file.close();
+    }
+    ByteVector written = FileManager::readBinaryFile("binary-mixed.bin");
+    ASSERT_EQ(written.size(), expected.size());
+    EXPECT_EQ(written, expected);
+}
+
+// Test that the destructor completes the file when close() is not called
+TEST(BinaryWriterTest, CloseOnDestruction)
+{
+    {
+        BinaryWriter file("binary-destructor.bin");
+        file.write(ByteVector{0x80});
+    }
+    EXPECT_EQ(FileManager::readBinaryFile("binary-destructor.bin"), (ByteVector{0x80}));
+}
+
+// Test that closing twice is allowed and writing after close throws
+TEST(BinaryWriterTest, WriteAfterClose)
+{
+    BinaryWriter file("binary-closed.bin");
+    file.write(0x01);
+    file.close();
+    EXPECT_NO_THROW(file.close());
+    EXPECT_THROW(file.write(0x02), std::runtime_error);
+}
+
+// Test that the byte vector sink appends
+TEST(BinaryWriterTest, ByteVectorSink)
+{
+    ByteVector output = {0x01};
+    ByteVectorSink sink(output);
+    sink.write(0x02);
+    sink.write(ByteVector{0x03, 0x04});
+    EXPECT_EQ(output, (ByteVector{0x01, 0x02, 0x03, 0x04}));
+}
+
+// Test for handling file open error
+TEST(BinaryWriterTest, FileOpenError)
+{
+    EXPECT_THROW(BinaryWriter("non_existent_directory/output.bin"), std::runtime_error);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -18,6 +18,26 @@ TEST(ByteVectorTest, ToString)
     EXPECT_EQ("Hello", bv.toString(Encoding::UTF16LE));
 }
 
+// Test for toString method with multi-byte and invalid UTF-8
+TEST(ByteVectorTest, ToStringUtf8)
+{
+    ByteVector bv = {0x53, 0x70, 0x4F, 0xE2, 0x82, 0x82, 0x00}; // 'SpO₂' followed by a null character
+    EXPECT_EQ(std::string("SpO\xE2\x82\x82\0", 7), bv.toString(Encoding::UTF8));
+    EXPECT_THROW(ByteVector({0x48, 0xFF}).toString(Encoding::UTF8), std::runtime_error);       // Invalid byte
+    EXPECT_THROW(ByteVector({0xC0, 0x80}).toString(Encoding::UTF8), std::runtime_error);       // Overlong encoding
+    EXPECT_THROW(ByteVector({0xED, 0xA0, 0x80}).toString(Encoding::UTF8), std::runtime_error); // Surrogate
+    EXPECT_THROW(ByteVector({0xE2, 0x82}).toString(Encoding::UTF8), std::runtime_error);       // Truncated sequence
+}
+
+// Test for toString method with UTF-16LE outside the ASCII range
+TEST(ByteVectorTest, ToStringUtf16)
+{
+    ByteVector bv = {0xE5, 0x65, 0x3D, 0xD8, 0x00, 0xDE}; // '日' and an emoji encoded with a surrogate pair
+    EXPECT_EQ("\xE6\x97\xA5\xF0\x9F\x98\x80", bv.toString(Encoding::UTF16LE));
+    EXPECT_THROW(ByteVector({0x3D, 0xD8, 0x41, 0x00}).toString(Encoding::UTF16LE), std::runtime_error); // Unpaired high surrogate
+    EXPECT_THROW(ByteVector({0x00, 0xDE}).toString(Encoding::UTF16LE), std::runtime_error);             // Unpaired low surrogate
+}
+
 // Test for toInt method
 TEST(ByteVectorTest, ToInt)
 {
@@ -38,6 +58,26 @@ TEST(ByteVectorTest, FromInt)
     EXPECT_EQ(expected, bv);
 }
 
+// Test for toInt method with fewer bytes than the return type
+TEST(ByteVectorTest, ToIntZeroExtends)
+{
+    ByteVector bv = {0x01, 0x02, 0x03};
+    EXPECT_EQ(0x010203u, bv.toInt<uint32_t>(ByteOrder::ENDIAN_BIG));
+    EXPECT_EQ(0x030201u, bv.toInt<uint32_t>(ByteOrder::ENDIAN_LITTLE));
+}
+
+// Test for ByteView slicing and comparison
+TEST(ByteVectorTest, ByteView)
+{
+    ByteVector bv = {0x0A, 0x0B, 0x0C, 0x0D};
+    ByteView view(bv);
+    EXPECT_EQ(view, bv);
+    EXPECT_EQ(view.subview(1, 2), ByteVector({0x0B, 0x0C}));
+    EXPECT_EQ("0B 0C", view.subview(1, 2).stringify());
+    EXPECT_THROW(view.subview(3, 2), std::runtime_error);
+    EXPECT_EQ(ByteVector(view.subview(2, 2)), ByteVector({0x0C, 0x0D}));
+}
+
 int main(int argc, char **argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
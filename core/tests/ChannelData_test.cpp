@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include "ChannelData.h"
+#include "MFERData.h"
+#include <cmath>
+
+// Test that samples are stored in their native type regardless of the source byte order
+TEST(ChannelDataTest, AppendByteOrder)
+{
+    uint8_t big[] = {0x01, 0x02, 0xFF, 0xFE};
+    uint8_t little[] = {0x02, 0x01, 0xFE, 0xFF};
+
+    ChannelData fromBig(DataType::INT_16_S);
+    fromBig.append(big, 2, ByteOrder::ENDIAN_BIG);
+    ChannelData fromLittle(DataType::INT_16_S);
+    fromLittle.append(little, 2, ByteOrder::ENDIAN_LITTLE);
+
+    ASSERT_EQ(fromBig.size(), 2);
+    EXPECT_EQ(fromBig.samples<int16_t>()[0], 0x0102);
+    EXPECT_EQ(fromBig.samples<int16_t>()[1], -2);
+    EXPECT_EQ(fromBig, fromLittle);
+}
+
+// Test conversion to doubles and physical units
+TEST(ChannelDataTest, Conversion)
+{
+    uint8_t bytes[] = {0x00, 0x80, 0x0A, 0x00, 0xF6, 0xFF}; // -32768 (missing), 10, -10
+    ChannelData data(DataType::INT_16_S, 0.5);
+    data.append(bytes, 3, ByteOrder::ENDIAN_LITTLE);
+
+    EXPECT_TRUE(std::isnan(data.value(0)));
+    EXPECT_EQ(data.value(1), 10);
+    EXPECT_EQ(data.physical(2), -5);
+    EXPECT_THROW(data.value(3), std::runtime_error);
+
+    std::vector<double> physical = data.toPhysical();
+    ASSERT_EQ(physical.size(), 3);
+    EXPECT_TRUE(std::isnan(physical[0]));
+    EXPECT_EQ(physical[1], 5);
+
+    double output[2];
+    data.toDoubles(1, 2, output);
+    EXPECT_EQ(output[1], -10);
+    EXPECT_THROW(data.toDoubles(2, 2, output), std::runtime_error);
+}
+
+// Test that typed access checks the sample type
+TEST(ChannelDataTest, TypedAccess)
+{
+    uint8_t bytes[] = {0x00, 0x00, 0x80, 0x3F}; // 1.0f
+    ChannelData data(DataType::FLOAT_32);
+    data.append(bytes, 1, ByteOrder::ENDIAN_LITTLE);
+
+    EXPECT_EQ(data.samples<float>()[0], 1.0f);
+    EXPECT_THROW(data.samples<int32_t>(), std::runtime_error);
+    EXPECT_THROW(data.samples<double>(), std::runtime_error);
+
+    ChannelData status(DataType::STATUS_16);
+    EXPECT_NO_THROW(status.samples<uint16_t>());
+    EXPECT_THROW(status.samples<int16_t>(), std::runtime_error);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include "CsvWriter.h"
+#include <fstream>
+#include <sstream>
+#include <limits>
+
+std::string readTextFile(const std::string &fileName)
+{
+    std::ifstream file(fileName);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+// Test that numbers are formatted the same way as std::ostream with the default precision
+TEST(CsvWriterTest, MatchesStreamFormatting)
+{
+    std::vector<double> values = {0, -0.0, 1, -1, 0.5, 0.002, 123456, 1234567, 0.0001, 0.00001, 3.14159265, -2.5e-7, 1e300,
+                                  std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::infinity()};
+    std::stringstream expected;
+    {
+        CsvWriter file("test-csvwriter-format.csv");
+        for (double value : values)
+        {
+            file.writeNumber(value);
+            file.writeSeparator();
+            expected << value << ", ";
+        }
+        file.endLine();
+        expected << '\n';
+    }
+    EXPECT_EQ(readTextFile("test-csvwriter-format.csv"), expected.str());
+}
+
+// Test for configurable precision
+TEST(CsvWriterTest, Precision)
+{
+    {
+        CsvWriter file("test-csvwriter-precision.csv", 10);
+        file.writeNumber(3.14159265358979);
+        file.close();
+    }
+    EXPECT_EQ(readTextFile("test-csvwriter-precision.csv"), "3.141592654");
+
+    EXPECT_THROW(CsvWriter("test-csvwriter-precision.csv", 0), std::runtime_error);
+    EXPECT_THROW(CsvWriter("test-csvwriter-precision.csv", 18), std::runtime_error);
+}
+
+// Test that output larger than the buffer is written in chunks without losing data
+TEST(CsvWriterTest, SmallBuffer)
+{
+    std::string expected;
+    {
+        CsvWriter file("test-csvwriter-buffer.csv", CsvWriter::defaultPrecision, 40);
+        std::string text(100, 'x');
+        file.write(text);
+        expected += text;
+        for (int i = 0; i < 1000; i++)
+        {
+            file.writeNumber(i * 0.25);
+            file.endLine();
+            std::stringstream line;
+            line << i * 0.25 << '\n';
+            expected += line.str();
+        }
+    }
+    EXPECT_EQ(readTextFile("test-csvwriter-buffer.csv"), expected);
+}
+
+// Test that an unwritable path is reported
+TEST(CsvWriterTest, OpenError)
+{
+    EXPECT_THROW(CsvWriter("nonexistent-directory/test.csv"), std::runtime_error);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
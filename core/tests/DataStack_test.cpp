@@ -103,6 +103,44 @@ TEST(DataStackTest, PopDoubles)
     EXPECT_EQ(ds.size(), 0);
 }
 
+// Test that pop_front returns a view into the original buffer
+TEST(DataStackTest, PopFrontView)
+{
+    ByteVector bv = {0x01, 0x02, 0x03, 0x04};
+    DataStack ds(bv);
+
+    ds.pop_byte();
+    ByteView view = ds.pop_front(2);
+
+    EXPECT_EQ(view.data(), bv.data() + 1);
+    EXPECT_EQ(view, ByteVector({0x02, 0x03}));
+    EXPECT_EQ(ds.size(), 1);
+}
+
+// Test for reading past the end of the buffer
+TEST(DataStackTest, PopOutOfRange)
+{
+    ByteVector bv = {0x01, 0x02, 0x03};
+    DataStack ds(bv);
+
+    EXPECT_THROW(ds.pop_front(4), std::runtime_error);
+    EXPECT_THROW(ds.pop_value<uint32_t>(), std::runtime_error);
+    EXPECT_EQ(ds.size(), 3); // Failed reads do not consume data
+    ds.pop_front(3);
+    EXPECT_THROW(ds.pop_byte(), std::runtime_error);
+    EXPECT_THROW(ds.read_byte(), std::runtime_error);
+}
+
+// Test for pop_value method with little endian byte order
+TEST(DataStackTest, PopValueLittleEndian)
+{
+    ByteVector bv = {0x02, 0x01, 0x00, 0x80};
+    DataStack ds(bv);
+
+    EXPECT_EQ(ds.pop_value<uint16_t>(ByteOrder::ENDIAN_LITTLE), 258);
+    EXPECT_EQ(ds.pop_value<int16_t>(ByteOrder::ENDIAN_LITTLE), -32768);
+}
+
 int main(int argc, char **argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include "FileIndex.h"
+#include "FileManager.h"
+#include "NihonKohdenData.h"
+
+namespace
+{
+    FileIndex sampleIndex()
+    {
+        FileIndex index;
+        index.fingerprint = {1000, 123456789, 0xABCDEF};
+        index.tagOffsets = {0, 34, 37};
+        index.header.preamble = "MFR";
+        index.header.patientName = "NAME";
+        index.header.samplingInterval = 0.001f;
+        index.header.waveformType = 0x14;
+        index.header.sequenceCount = 12;
+        index.header.channelCount = 1;
+        index.header.events.push_back({1, 2000, 30000, "NIBP 120/80 mmHg"});
+        Channel channel;
+        channel.leadInfo = findLeadInfo(Lead::ART);
+        channel.dataType = DataType::INT_16_S;
+        channel.blockLength = 7500;
+        channel.samplingInterval = 0.008f;
+        channel.samplingIntervalString = "8x10^-3 (s)";
+        channel.samplingResolution = 0.125f;
+        index.header.channels.push_back(channel);
+        index.waveformOffset = 500;
+        index.waveformLength = 180000;
+        index.sequenceSize = 15000;
+        return index;
+    }
+}
+
+// Test that an index is read back as written
+TEST(FileIndexTest, RoundTrip)
+{
+    FileIndex index = parseFileIndex(serializeFileIndex(sampleIndex()));
+    FileIndex expected = sampleIndex();
+
+    EXPECT_EQ(index.fingerprint, expected.fingerprint);
+    EXPECT_EQ(index.tagOffsets, expected.tagOffsets);
+    EXPECT_EQ(index.waveformOffset, 500);
+    EXPECT_EQ(index.waveformLength, 180000);
+    EXPECT_EQ(index.sequenceSize, 15000);
+    EXPECT_EQ(index.header.patientName, ""); // Patient fields are not stored
+    expected.header.patientName = "";
+    EXPECT_EQ(index.header.toString(), expected.header.toString());
+    ASSERT_EQ(index.header.events.size(), 1);
+    EXPECT_EQ(index.header.events[0].information, "NIBP 120/80 mmHg");
+    ASSERT_EQ(index.header.channels.size(), 1);
+    EXPECT_EQ(index.header.channels[0].leadInfo.lead, Lead::ART);
+    EXPECT_EQ(index.header.channels[0].leadInfo.unitCode, 1);
+    EXPECT_FLOAT_EQ(index.header.channels[0].samplingResolution, 0.125f);
+}
+
+// Test that truncated, modified and foreign indexes are rejected
+TEST(FileIndexTest, CorruptIndex)
+{
+    ByteVector bytes = serializeFileIndex(sampleIndex());
+
+    EXPECT_THROW(parseFileIndex(ByteVector()), std::runtime_error);
+    EXPECT_THROW(parseFileIndex(ByteView(bytes.data(), bytes.size() - 1)), std::runtime_error);
+    for (size_t offset : {size_t(0), size_t(9), size_t(40), bytes.size() - 1})
+    {
+        ByteVector modified = bytes;
+        modified[offset] ^= 0x01;
+        EXPECT_THROW(parseFileIndex(modified), std::runtime_error);
+    }
+}
+
+// Test that the fingerprint covers the header but not the waveform
+TEST(FileIndexTest, Fingerprint)
+{
+    ByteVector bv = FileManager::readBinaryFile("test-file.MWF");
+    FileManager::writeBinaryFile("fingerprint.MWF", bv);
+    NihonKohdenData("fingerprint.MWF", true); // Writes the index
+    FileIndex index = parseFileIndex(FileManager::readBinaryFile(getIndexFileName("fingerprint.MWF")));
+    uint64_t offset = index.waveformOffset;
+    uint64_t length = index.waveformLength;
+    FileFingerprint fingerprint = getFingerprint("fingerprint.MWF", bv, offset, length);
+    EXPECT_EQ(fingerprint, index.fingerprint);
+
+    ByteVector samples = bv;
+    samples[offset + 10] ^= 0xFF;
+    EXPECT_EQ(getFingerprint("fingerprint.MWF", samples, offset, length).headerHash, fingerprint.headerHash);
+    ByteVector header = bv;
+    header[40] ^= 0xFF;
+    EXPECT_NE(getFingerprint("fingerprint.MWF", header, offset, length).headerHash, fingerprint.headerHash);
+
+    EXPECT_THROW(getFingerprint("fingerprint.MWF", bv, bv.size(), 1), std::runtime_error);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -2,6 +2,8 @@
 #include "MFERDataCollection.h"
 #include "MFERData.h"
 #include "ByteVector.h"
+#include "FileManager.h"
+#include "MappedFile.h"
 
 // Test for MFERDataCollection initialization
 TEST(MFERDataCollectionTest, Initialization)
@@ -64,6 +66,41 @@ TEST(MFERDataCollectionTest, CollectionToHexString)
     EXPECT_EQ(hexString, expected);
 }
 
+// Test that the elements of a file are allocated in a few arena blocks
+TEST(MFERDataCollectionTest, ArenaAllocation)
+{
+    std::shared_ptr<const MappedFile> file = MappedFile::open("test-file.MWF");
+    MFERDataCollection mapped(file->view(), file);
+    ASSERT_EQ(mapped.size(), 24);
+    EXPECT_EQ(mapped.getArena().getBlockCount(), 1); // The waveform is referenced in place
+
+    ByteVector bv = FileManager::readBinaryFile("test-file.MWF");
+    MFERDataCollection copied(bv);
+    EXPECT_EQ(copied.getArena().getBlockCount(), 2); // The copied waveform takes a block of its own
+    EXPECT_EQ(copied.toByteVector(), bv);
+
+    MFERDataCollection moved = std::move(copied);
+    EXPECT_EQ(moved.size(), mapped.size());
+    EXPECT_EQ(moved.getArena().getBlockCount(), 2);
+    EXPECT_EQ(moved.toByteVector(), bv);
+}
+
+// Test that channel attributes are parsed into the arena of the collection
+TEST(MFERDataCollectionTest, ChannelAttributes)
+{
+    ByteVector bv = {0x3F, 0x00, 0x07, 0x0A, 0x01, 0x00, 0x04, 0x02, 0x3A, 0x98, 0x80};
+    MFERDataCollection collection(bv);
+
+    ASSERT_EQ(collection.size(), 2);
+    ATT *att = dynamic_cast<ATT *>(collection.getMFERDataVector()[0]);
+    ASSERT_NE(att, nullptr);
+    ASSERT_EQ(att->getAttributes().size(), 2);
+    EXPECT_EQ(att->getAttributes()[0]->getTag(), 0x0A);
+    EXPECT_EQ(att->getAttributes()[1]->getTag(), 0x04);
+    EXPECT_EQ(att->getChannel(ByteOrder::ENDIAN_BIG).blockLength, 15000);
+    EXPECT_EQ(collection.toByteVector(), bv);
+}
+
 int main(int argc, char **argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -113,6 +113,99 @@ TEST(MFERDataTest, IVLGetSamplingInterval)
     EXPECT_FLOAT_EQ(dynamic_cast<IVL *>(ivlData.get())->getSamplingInterval(), 0.001);
 }
 
+// Test that long contents are stored by the element and anonymized in place
+TEST(MFERDataTest, LongContents)
+{
+    ByteVector bv = {0x82, 0x14};
+    for (uint8_t i = 0; i < 0x14; i++)
+    {
+        bv.push_back('A' + i);
+    }
+    auto pidData = [&]()
+    {
+        DataStack ds(bv);
+        return parseMFERData(&ds);
+    }();
+    bv.assign(bv.size(), 0xEE); // Contents must not refer to the parsed buffer
+
+    EXPECT_EQ(pidData->toString(), "ABCDEFGHIJKLMNOPQRST");
+    pidData->anonymize();
+    EXPECT_EQ(pidData->getContents(), ByteVector(0x14, 0x00));
+}
+
+// Test for ATT built for writing, which holds its attributes itself
+TEST(MFERDataTest, ATTAttributes)
+{
+    std::vector<std::unique_ptr<MFERData>> attributes;
+    attributes.push_back(std::make_unique<DTP>(ByteVector{0x07}));
+    attributes.push_back(std::make_unique<BLK>(ByteVector{0x00, 0x00, 0x00, 0x10}));
+    ATT att(3, attributes);
+
+    ASSERT_EQ(att.getAttributes().size(), 2);
+    Channel channel = att.getChannel(ByteOrder::ENDIAN_BIG);
+    EXPECT_EQ(channel.dataType, DataType::FLOAT_32);
+    EXPECT_EQ(channel.blockLength, 16);
+    EXPECT_EQ(att.toByteVector(), ByteVector({0x3F, 0x03, 0x09, 0x0A, 0x01, 0x07, 0x04, 0x04, 0x00, 0x00, 0x00, 0x10}));
+}
+
+// Test that elements are created and visited as the type registered for their tag
+TEST(MFERDataTest, RegistryDispatch)
+{
+    ByteVector bv = {0x01, 0x01, 0x00, 0x0A, 0x01, 0x07, 0x7E, 0x00};
+    DataStack ds(bv);
+    std::unique_ptr<MFERData> ble(MFERDataTypes::create(ds.pop_byte(), &ds, nullptr));
+    std::unique_ptr<MFERData> dtp(MFERDataTypes::create(ds.pop_byte(), &ds, nullptr));
+    EXPECT_EQ(MFERDataTypes::create(ds.pop_byte(), &ds, nullptr), nullptr); // 0x7E is not a tag
+
+    MFERDataVisitor describe{
+        [](const BLE &data)
+        { return std::string("BLE ") + (data.getByteOrder() == ByteOrder::ENDIAN_BIG ? "big" : "little"); },
+        [](const DTP &data)
+        { return std::string("DTP ") + std::to_string(static_cast<int>(data.getDataType())); },
+        [](const MFERData &data)
+        { return std::string("other ") + std::to_string(data.getTag()); },
+    };
+    EXPECT_EQ(visitMFERData(*ble, describe), "BLE big");
+    EXPECT_EQ(visitMFERData(*dtp, describe), "DTP 7");
+
+    ByteVector pre = {0x40, 0x01, 0x00};
+    DataStack preStack(pre);
+    EXPECT_EQ(visitMFERData(*parseMFERData(&preStack), describe), "other 64");
+    MFERData data(ByteVector{0x01});
+    EXPECT_EQ(visitMFERData(data, describe), "other 0"); // Not registered
+
+    EXPECT_THROW(parseMFERData(&ds), std::runtime_error); // Only the unknown tag's contents are left
+}
+
+// Test that the channel descriptor is decoded once, in both byte orders
+TEST(MFERDataTest, ATTDescriptor)
+{
+    std::vector<std::unique_ptr<MFERData>> attributes;
+    attributes.push_back(std::make_unique<LDN>(ByteVector{0x00, 0x02}));
+    attributes.push_back(std::make_unique<BLK>(ByteVector{0x00, 0x00, 0x3A, 0x98}));
+    attributes.push_back(std::make_unique<IVL>(ByteVector{0x01, 0xFD, 0x04}));
+    attributes.push_back(std::make_unique<SEN>(ByteVector{0x00, 0xFA, 0x00, 0x02}));
+    ATT att(0, attributes);
+
+    const ChannelDescriptor &descriptor = att.getDescriptor();
+    EXPECT_TRUE(descriptor.hasLead);
+    EXPECT_EQ(descriptor.lead[static_cast<size_t>(ByteOrder::ENDIAN_BIG)], Lead::ECG_II);
+    EXPECT_EQ(descriptor.blockLength[static_cast<size_t>(ByteOrder::ENDIAN_BIG)], 15000);
+    EXPECT_EQ(descriptor.dataType, DataType::INT_16_S); // Default without DTP
+
+    Channel channel = att.getChannel(ByteOrder::ENDIAN_BIG);
+    EXPECT_EQ(channel.leadInfo.attribute, "ECG II");
+    EXPECT_EQ(channel.blockLength, 15000);
+    EXPECT_FLOAT_EQ(channel.samplingInterval, 0.004);
+    EXPECT_EQ(channel.samplingIntervalString, "4x10^-3 (s)");
+    EXPECT_FLOAT_EQ(channel.samplingResolution, 2e-6);
+
+    Channel little = att.getChannel(ByteOrder::ENDIAN_LITTLE);
+    EXPECT_EQ(little.leadInfo.attribute, "Unknown (0x200)");
+    EXPECT_EQ(little.blockLength, 0x983A0000u);
+    EXPECT_FLOAT_EQ(little.samplingResolution, 512e-6);
+}
+
 // Test required for NIBPEvent, specification unavailable
 
 int main(int argc, char **argv)
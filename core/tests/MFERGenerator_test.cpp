@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include "MFERGenerator.h"
+#include "NihonKohdenData.h"
+#include "FileManager.h"
+#include <cmath>
+
+// Test that the default options give the layout of the test file
+TEST(MFERGeneratorTest, DefaultLayout)
+{
+    ByteVector bytes = generateMFER(GeneratorOptions());
+    NihonKohdenData generated{ByteView(bytes)};
+    NihonKohdenData nkData("test-file.MWF");
+
+    const Header &header = generated.getMetadata();
+    const Header &expected = nkData.getMetadata();
+    EXPECT_EQ(header.byteOrder, expected.byteOrder);
+    EXPECT_EQ(header.sequenceCount, expected.sequenceCount);
+    EXPECT_EQ(header.samplingInterval, expected.samplingInterval);
+    EXPECT_EQ(header.measurementTimeISO, "2020-01-01T00:00:00");
+    ASSERT_EQ(header.channels.size(), expected.channels.size());
+    for (size_t i = 0; i < header.channels.size(); i++)
+    {
+        EXPECT_EQ(header.channels[i].leadInfo.lead, expected.channels[i].leadInfo.lead);
+        EXPECT_EQ(header.channels[i].dataType, expected.channels[i].dataType);
+        EXPECT_EQ(header.channels[i].blockLength, expected.channels[i].blockLength);
+        EXPECT_EQ(header.channels[i].samplingInterval, expected.channels[i].samplingInterval);
+        EXPECT_EQ(header.channels[i].samplingResolution, expected.channels[i].samplingResolution);
+    }
+    EXPECT_EQ(generated.getWaveform().size(), nkData.getWaveform().size());
+
+    // The tags are written back unchanged
+    generated.writeToBinary("output-generated.MWF");
+    EXPECT_EQ(FileManager::readBinaryFile("output-generated.MWF"), bytes);
+}
+
+// Test that the same seed gives the same recording, in either byte order
+TEST(MFERGeneratorTest, Deterministic)
+{
+    GeneratorOptions options;
+    options.seed = 7;
+    ByteVector first = generateMFER(options);
+    EXPECT_EQ(generateMFER(options), first);
+
+    options.byteOrder = ByteOrder::ENDIAN_BIG;
+    ByteVector big = generateMFER(options);
+    EXPECT_NE(big, first);
+    NihonKohdenData little{ByteView(first)};
+    NihonKohdenData bigData{ByteView(big)};
+    for (size_t i = 0; i < options.channels.size(); i++)
+    {
+        EXPECT_EQ(bigData.getChannelData(i), little.getChannelData(i));
+    }
+
+    options.byteOrder = ByteOrder::ENDIAN_LITTLE;
+    options.seed = 8;
+    EXPECT_NE(generateMFER(options), first);
+}
+
+// Test a mix of data types, missing samples and events
+TEST(MFERGeneratorTest, DataTypes)
+{
+    GeneratorOptions options;
+    options.channels.clear();
+    for (DataType dataType : {DataType::INT_16_S, DataType::INT_16_U, DataType::INT_32_S, DataType::INT_8_U, DataType::STATUS_16,
+                              DataType::INT_8_S, DataType::INT_32_U, DataType::FLOAT_32, DataType::FLOAT_64})
+    {
+        options.channels.push_back({Lead::ECG_I, dataType, 500, 2, -6, 2});
+    }
+    options.channels.push_back({Lead::RESP, DataType::INT_16_S, 250, 4, -2, 1});
+    options.sequenceCount = 3;
+    options.samplingInterval = 2;
+    options.eventCount = 2;
+    options.missingDensity = 1;
+
+    ByteVector bytes = generateMFER(options);
+    NihonKohdenData nkData{ByteView(bytes)};
+    const Header &header = nkData.getHeader();
+    ASSERT_EQ(header.channels.size(), 10);
+    EXPECT_EQ(header.events.size(), 2);
+    EXPECT_EQ(header.samplingInterval, 0.002f);
+    for (size_t i = 0; i < options.channels.size(); i++)
+    {
+        EXPECT_EQ(header.channels[i].dataType, options.channels[i].dataType);
+        EXPECT_EQ(header.channels[i].data.size(), 3 * options.channels[i].blockLength);
+    }
+    EXPECT_TRUE(std::isnan(header.channels[0].data.value(0))); // Every INT_16_S and float sample is missing
+    EXPECT_TRUE(std::isnan(header.channels[7].data.value(10)));
+    EXPECT_FALSE(std::isnan(header.channels[2].data.value(10)));
+}
+
+// Test that invalid options are rejected
+TEST(MFERGeneratorTest, InvalidOptions)
+{
+    GeneratorOptions options;
+    options.channels[2].samplingInterval = 4; // Half the duration of the other channels
+    EXPECT_THROW(generateMFER(options), std::runtime_error);
+
+    options = GeneratorOptions();
+    options.channels.clear();
+    EXPECT_THROW(generateMFER(options), std::runtime_error);
+
+    options = GeneratorOptions();
+    options.channels[0].dataType = DataType::AHA_8;
+    EXPECT_THROW(generateMFER(options), std::runtime_error);
+
+    EXPECT_EQ(getDataTypeFromName(getDataTypeName(DataType::FLOAT_32)), DataType::FLOAT_32);
+    EXPECT_THROW(getDataTypeFromName("int64"), std::runtime_error);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
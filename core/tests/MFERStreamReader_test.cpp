@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include "MFERStreamReader.h"
+#include "MFERDataCollection.h"
+#include "FileManager.h"
+#include <fstream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Helper function to read every item from a stream reader
+struct StreamContents
+{
+    std::vector<uint8_t> tags;
+    ByteVector waveform;
+    std::vector<size_t> chunkSizes;
+    bool ended = false;
+};
+
+StreamContents readAll(MFERStreamReader &reader)
+{
+    StreamContents contents;
+    MFERStreamReader::Item item;
+    while (reader.next(item))
+    {
+        if (item.type == MFERStreamReader::ItemType::ELEMENT)
+        {
+            contents.tags.push_back(item.element->getTag());
+        }
+        else if (item.type == MFERStreamReader::ItemType::WAVEFORM)
+        {
+            contents.waveform.insert(contents.waveform.end(), item.waveform.begin(), item.waveform.end());
+            contents.chunkSizes.push_back(item.waveform.size());
+        }
+        else
+        {
+            contents.ended = true;
+        }
+    }
+    return contents;
+}
+
+// Test that streaming yields the same elements and payload as parsing the whole file
+TEST(MFERStreamReaderTest, MatchesCollection)
+{
+    ByteVector bv = FileManager::readBinaryFile("test-file.MWF");
+    MFERDataCollection collection(bv);
+
+    std::ifstream file("test-file.MWF", std::ios::binary);
+    MFERStreamReader reader(file);
+    StreamContents contents = readAll(reader);
+
+    std::vector<uint8_t> expectedTags;
+    ByteVector expectedWaveform;
+    for (const auto &data : collection.getMFERDataVector())
+    {
+        if (data->getTag() == WAV::tag)
+        {
+            expectedWaveform = data->getContents();
+        }
+        else if (data->getTag() != END::tag)
+        {
+            expectedTags.push_back(data->getTag());
+        }
+    }
+
+    EXPECT_EQ(contents.tags, expectedTags);
+    EXPECT_EQ(contents.waveform, expectedWaveform);
+    EXPECT_TRUE(contents.ended);
+    EXPECT_EQ(reader.getSequenceCount(), 12);
+    EXPECT_EQ(reader.getChannels().size(), 6);
+    EXPECT_EQ(reader.getWaveformLength(), expectedWaveform.size());
+    EXPECT_EQ(reader.getOffset(), bv.size());
+}
+
+// Test that waveform chunks contain whole sequences
+TEST(MFERStreamReaderTest, ChunksHoldWholeSequences)
+{
+    std::ifstream file("test-file.MWF", std::ios::binary);
+    MFERStreamReader reader(file, 1);
+    StreamContents contents = readAll(reader);
+
+    ASSERT_EQ(contents.chunkSizes.size(), reader.getSequenceCount());
+    for (size_t chunkSize : contents.chunkSizes)
+    {
+        EXPECT_EQ(chunkSize, reader.getSequenceSize());
+    }
+}
+
+// Test for a stream that ends in the middle of an element
+TEST(MFERStreamReaderTest, TruncatedStream)
+{
+    std::istringstream stream(std::string("\x40\x03\x0A\x0B", 4));
+    MFERStreamReader reader(stream);
+    MFERStreamReader::Item item;
+
+    EXPECT_THROW(reader.next(item), std::runtime_error);
+}
+
+// Test for a stream without an end of file tag
+TEST(MFERStreamReaderTest, StreamWithoutEnd)
+{
+    std::istringstream stream(std::string("\x40\x03\x0A\x0B\x0C", 5));
+    MFERStreamReader reader(stream);
+    StreamContents contents = readAll(reader);
+
+    EXPECT_EQ(contents.tags, std::vector<uint8_t>({PRE::tag}));
+    EXPECT_FALSE(contents.ended);
+}
+
+#ifndef _WIN32
+// Test for reading from a file descriptor
+TEST(MFERStreamReaderTest, FileDescriptor)
+{
+    int fileDescriptor = open("test-file.MWF", O_RDONLY);
+    ASSERT_GE(fileDescriptor, 0);
+    MFERStreamReader reader(fileDescriptor);
+    StreamContents contents = readAll(reader);
+    close(fileDescriptor);
+
+    EXPECT_TRUE(contents.ended);
+    EXPECT_EQ(contents.waveform.size(), reader.getWaveformLength());
+}
+#endif
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
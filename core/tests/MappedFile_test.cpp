@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+#include "MappedFile.h"
+#include "FileManager.h"
+#include <fstream>
+
+// Test that a mapped file has the same contents as a file read into memory
+TEST(MappedFileTest, MatchesReadFile)
+{
+    MappedFile file("test-file.MWF");
+    ByteVector bv = FileManager::readBinaryFile("test-file.MWF");
+
+    ASSERT_EQ(file.size(), bv.size());
+    EXPECT_EQ(file.view(), bv);
+
+    MappedFile windowed("test-file.MWF", MappedFile::Access::NORMAL); // Only the paging hint differs
+    EXPECT_EQ(windowed.view(), bv);
+}
+
+// Test that a shared mapping outlives the scope it was opened in
+TEST(MappedFileTest, SharedOwnership)
+{
+    std::shared_ptr<const void> owner;
+    ByteView view;
+    {
+        std::shared_ptr<const MappedFile> file = MappedFile::open("test-file.MWF");
+        owner = file;
+        view = file->view();
+    }
+    ASSERT_GT(view.size(), 4);
+    EXPECT_EQ(view[0], 0x40); // PRE tag
+}
+
+// Test for mapping an empty file
+TEST(MappedFileTest, EmptyFile)
+{
+    std::ofstream("empty.mwf", std::ios::binary).close();
+    MappedFile file("empty.mwf");
+
+    EXPECT_EQ(file.size(), 0);
+    EXPECT_TRUE(file.view().empty());
+}
+
+// Test for handling file open error
+TEST(MappedFileTest, FileOpenError)
+{
+    EXPECT_THROW(MappedFile("non_existent.mwf"), std::runtime_error);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
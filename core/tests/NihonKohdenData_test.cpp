@@ -3,8 +3,11 @@
 #include "FileManager.h"
 #include "ByteVector.h"
 #include "MFERDataCollection.h"
+#include "Anonymizer.h"
 #include <algorithm>
 #include <sstream>
+#include <fstream>
+#include <cmath>
 
 // Helper function to trim null characters
 std::string trimNulls(const std::string &str)
@@ -69,6 +72,89 @@ TEST(NihonKohdenDataTest, Anonymize)
     EXPECT_EQ(trimNulls(header.patientName), "");
 }
 
+// Test that metadata is available without decoding channel data
+TEST(NihonKohdenDataTest, GetMetadata)
+{
+    NihonKohdenData nkData("test-file.MWF");
+
+    const Header &metadata = nkData.getMetadata();
+    EXPECT_EQ(metadata.sequenceCount, 12);
+    ASSERT_EQ(metadata.channels.size(), 6);
+    EXPECT_EQ(metadata.channels[2].blockLength, 7500);
+    for (const auto &channel : metadata.channels)
+    {
+        EXPECT_TRUE(channel.data.empty());
+    }
+}
+
+// Test for decoding a single channel on request
+TEST(NihonKohdenDataTest, GetChannelData)
+{
+    NihonKohdenData nkData("test-file.MWF");
+    Header header = nkData.getHeader();
+
+    for (size_t i = 0; i < header.channels.size(); i++)
+    {
+        const ChannelData &data = nkData.getChannelData(i);
+        EXPECT_EQ(data.size(), header.sequenceCount * header.channels[i].blockLength);
+        EXPECT_EQ(data.getDataType(), header.channels[i].dataType);
+        EXPECT_EQ(data, header.channels[i].data);
+    }
+    EXPECT_THROW(nkData.getChannelData(6), std::runtime_error);
+}
+
+// Test that channels are stored in their native data type
+TEST(NihonKohdenDataTest, ChannelDataNativeType)
+{
+    NihonKohdenData nkData("test-file.MWF");
+
+    const ChannelData &ecg = nkData.getChannelData(0);
+    EXPECT_EQ(ecg.getDataType(), DataType::INT_16_S);
+    EXPECT_EQ(ecg.getBytes().size(), ecg.size() * sizeof(int16_t));
+    EXPECT_EQ(ecg.samples<int16_t>()[0], 18);
+    EXPECT_EQ(ecg.value(0), 18);
+    EXPECT_FLOAT_EQ(ecg.physical(0), 18 * 2e-6);
+    EXPECT_THROW(ecg.samples<uint16_t>(), std::runtime_error);
+
+    const ChannelData &art = nkData.getChannelData(2);
+    EXPECT_EQ(art.samples<int16_t>()[0], 774);
+    std::vector<double> physical = art.toPhysical();
+    ASSERT_EQ(physical.size(), art.size());
+    EXPECT_FLOAT_EQ(physical[0], 774 * 0.125);
+
+    EXPECT_EQ(nkData.getChannelData(5).getDataType(), DataType::STATUS_16);
+    EXPECT_EQ(nkData.getChannelData(5).samples<uint16_t>()[0], 0);
+}
+
+// Test that the header is decoded once and shared between calls
+TEST(NihonKohdenDataTest, GetHeaderCached)
+{
+    NihonKohdenData nkData("test-file.MWF");
+
+    const Header &header = nkData.getHeader();
+    EXPECT_EQ(&header, &nkData.getHeader());
+    ASSERT_EQ(header.channels.size(), 6);
+    EXPECT_EQ(header.channels[0].data.getBytes().data(), nkData.getChannelData(0).getBytes().data());
+    EXPECT_EQ(header.channels[0].data.size(), 12 * 15000);
+}
+
+// Test that anonymizing refreshes the cached header and keeps decoded channel data
+TEST(NihonKohdenDataTest, AnonymizeRefreshesHeader)
+{
+    NihonKohdenData nkData("test-file.MWF");
+    const Header &header = nkData.getHeader();
+    const Channel *channel = &header.channels[1];
+    const uint8_t *samples = header.channels[1].data.getBytes().data();
+    EXPECT_EQ(trimNulls(header.patientID), "12345");
+
+    nkData.anonymize();
+    EXPECT_EQ(trimNulls(header.patientID), "");
+    EXPECT_EQ(trimNulls(nkData.getMetadata().patientID), "");
+    EXPECT_EQ(&header.channels[1], channel);
+    EXPECT_EQ(header.channels[1].data.getBytes().data(), samples);
+    EXPECT_EQ(nkData.getWaveform().size(), 1620000);
+}
+
 // Test for setChannelSelection method
 TEST(NihonKohdenDataTest, SetChannelSelection)
 {
@@ -79,6 +165,35 @@ TEST(NihonKohdenDataTest, SetChannelSelection)
     EXPECT_THROW(nkData.setChannelSelection(17, true), std::runtime_error);
 }
 
+// Test for selecting channels by lead, and that unselected channels are not decoded
+TEST(NihonKohdenDataTest, SetChannelSelectionByLead)
+{
+    NihonKohdenData nkData("test-file.MWF");
+    ASSERT_EQ(nkData.getChannelSelection().size(), 6);
+    EXPECT_THROW(nkData.setChannelSelection(6, true), std::runtime_error);
+
+    for (size_t i = 0; i < 6; i++)
+    {
+        nkData.setChannelSelection(i, false);
+    }
+    nkData.setChannelSelection(Lead::ART, true);
+    EXPECT_EQ(nkData.getChannelSelection(), std::vector<bool>({false, false, true, false, false, false}));
+    EXPECT_THROW(nkData.setChannelSelection(Lead::EEG, true), std::runtime_error);
+
+    const Header &header = nkData.getHeader();
+    EXPECT_EQ(header.channels[2].data.size(), 12 * 7500);
+    EXPECT_TRUE(header.channels[0].data.empty());
+    EXPECT_TRUE(header.channels[5].data.empty());
+
+    nkData.writeToCsv("output-lead.csv");
+    std::ifstream file("output-lead.csv");
+    std::string line;
+    std::getline(file, line);
+    EXPECT_EQ(line, "Time: (s), ART: 125x10^-3 (mmHg)");
+    std::getline(file, line);
+    EXPECT_EQ(line, "0, 774");
+}
+
 // Test for setIntervalSelection method
 TEST(NihonKohdenDataTest, SetIntervalSelection)
 {
@@ -229,6 +344,112 @@ TEST(NihonKohdenDataTest, WriteToBinary)
     EXPECT_TRUE(std::equal(writtenData.begin(), writtenData.end(), bv.begin()));
 }
 
+// Test for writeToBinary method on a file mapped from disk
+TEST(NihonKohdenDataTest, WriteToBinaryFromFileName)
+{
+    NihonKohdenData nkData("test-file.MWF");
+    std::string fileName = "output-mapped.mwf";
+
+    nkData.writeToBinary(fileName);
+
+    ByteVector writtenData = FileManager::readBinaryFile(fileName);
+    ByteVector bv = FileManager::readBinaryFile("test-file.MWF");
+    EXPECT_EQ(writtenData, bv);
+}
+
+// Test for writeToBinary method onto the file the data is mapped from
+TEST(NihonKohdenDataTest, WriteToBinaryOverSource)
+{
+    ByteVector bv = FileManager::readBinaryFile("test-file.MWF");
+    FileManager::writeBinaryFile("output-source.mwf", bv);
+    {
+        NihonKohdenData nkData("output-source.mwf");
+        nkData.anonymize();
+        nkData.writeToBinary("output-source.mwf");
+        EXPECT_EQ(nkData.getHeader().channels.size(), 6); // Still readable after the source is replaced
+    }
+
+    NihonKohdenData nkDataAnonymized("output-source.mwf");
+    EXPECT_EQ(trimNulls(nkDataAnonymized.getHeader().patientID), "");
+    EXPECT_EQ(FileManager::readBinaryFile("output-source.mwf").size(), bv.size());
+    EXPECT_FALSE(std::ifstream("output-source.mwf.part").good());
+}
+
+// Test that a file reopened with its index matches the parsed file
+TEST(NihonKohdenDataTest, UseIndex)
+{
+    ByteVector bv = FileManager::readBinaryFile("test-file.MWF");
+    FileManager::writeBinaryFile("output-indexed.mwf", bv);
+    std::remove("output-indexed.mwf.idx");
+
+    NihonKohdenData parsed("output-indexed.mwf", true);
+    EXPECT_FALSE(parsed.isIndexed());
+    EXPECT_TRUE(std::ifstream("output-indexed.mwf.idx").good());
+
+    NihonKohdenData indexed("output-indexed.mwf", true);
+    EXPECT_TRUE(indexed.isIndexed());
+    EXPECT_EQ(indexed.getHeader().toString(), parsed.getHeader().toString());
+    ASSERT_EQ(indexed.getHeader().channels.size(), 6);
+    for (size_t i = 0; i < 6; i++)
+    {
+        EXPECT_EQ(indexed.getChannelData(i), parsed.getChannelData(i));
+    }
+
+    // The tags are parsed from the stored offsets when needed
+    indexed.writeToBinary("output-indexed-copy.mwf");
+    EXPECT_EQ(FileManager::readBinaryFile("output-indexed-copy.mwf"), bv);
+    indexed.anonymize();
+    EXPECT_EQ(trimNulls(indexed.getHeader().patientID), "");
+}
+
+// Test that a stale or corrupt index is rebuilt
+TEST(NihonKohdenDataTest, UseIndexRebuild)
+{
+    ByteVector bv = FileManager::readBinaryFile("test-file.MWF");
+    FileManager::writeBinaryFile("output-reindexed.mwf", bv);
+    std::remove("output-reindexed.mwf.idx");
+    NihonKohdenData("output-reindexed.mwf", true);
+
+    anonymizeFile("output-reindexed.mwf");
+    NihonKohdenData stale("output-reindexed.mwf", true);
+    EXPECT_FALSE(stale.isIndexed());
+    EXPECT_EQ(trimNulls(stale.getHeader().patientID), "");
+    EXPECT_TRUE(NihonKohdenData("output-reindexed.mwf", true).isIndexed());
+
+    FileManager::writeBinaryFile("output-reindexed.mwf.idx", ByteVector(64, 0xAB));
+    EXPECT_FALSE(NihonKohdenData("output-reindexed.mwf", true).isIndexed());
+    EXPECT_TRUE(NihonKohdenData("output-reindexed.mwf", true).isIndexed());
+}
+
+// Test that the index holds no patient fields, before or after anonymizing the file in place
+TEST(NihonKohdenDataTest, IndexWithoutPatientFields)
+{
+    ByteVector bv = FileManager::readBinaryFile("test-file.MWF");
+    FileManager::writeBinaryFile("output-patient.mwf", bv);
+    std::remove("output-patient.mwf.idx");
+    NihonKohdenData("output-patient.mwf", true);
+
+    auto contains = [](const ByteVector &bytes, const std::string &text)
+    {
+        return std::search(bytes.begin(), bytes.end(), text.begin(), text.end()) != bytes.end();
+    };
+    NihonKohdenData indexed("output-patient.mwf", true);
+    ASSERT_TRUE(indexed.isIndexed());
+    std::string patientID = trimNulls(indexed.getMetadata().patientID); // Decoded from the file
+    std::string patientName = trimNulls(indexed.getMetadata().patientName);
+    EXPECT_EQ(patientID, "12345");
+    EXPECT_EQ(patientName, "TRWRU");
+    ByteVector index = FileManager::readBinaryFile("output-patient.mwf.idx");
+    EXPECT_FALSE(contains(index, patientID));
+    EXPECT_FALSE(contains(index, patientName));
+
+    anonymizeFile("output-patient.mwf");
+    index = FileManager::readBinaryFile("output-patient.mwf.idx");
+    EXPECT_FALSE(contains(index, patientID));
+    EXPECT_FALSE(contains(index, patientName));
+    EXPECT_EQ(trimNulls(NihonKohdenData("output-patient.mwf", true).getMetadata().patientName), "");
+}
+
 // Test for writeToCsv method
 TEST(NihonKohdenDataTest, WriteToCsv)
 {
@@ -248,6 +469,224 @@ TEST(NihonKohdenDataTest, WriteToCsv)
     file.close();
 }
 
+// Test that parallel csv conversion writes the same file as a single thread
+TEST(NihonKohdenDataTest, WriteToCsvThreads)
+{
+    NihonKohdenData nkData("test-file.MWF");
+    nkData.setIntervalSelection(100.5, 130);
+    nkData.setChannelSelection(2, false);
+
+    auto readFile = [](const std::string &fileName)
+    {
+        std::ifstream file(fileName);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        return contents.str();
+    };
+
+    nkData.writeToCsv("output-single.csv");
+    std::string expected = readFile("output-single.csv");
+    for (unsigned int threads : {0u, 2u, 3u, 16u})
+    {
+        nkData.writeToCsv("output-threads.csv", CsvWriter::defaultPrecision, threads);
+        EXPECT_EQ(readFile("output-threads.csv"), expected) << threads << " threads";
+    }
+}
+
+// Test that a time is located to its sequence and sample
+TEST(NihonKohdenDataTest, GetSamplePosition)
+{
+    NihonKohdenData nkData("test-file.MWF");
+
+    SamplePosition position = nkData.getSamplePosition(0, 100.502); // 4 ms interval, 15000 samples per sequence
+    EXPECT_EQ(position.sequence, 1);
+    EXPECT_EQ(position.sample, 10125);
+    position = nkData.getSamplePosition(2, 100.502); // 8 ms interval, 7500 samples per sequence
+    EXPECT_EQ(position.sequence, 1);
+    EXPECT_EQ(position.sample, 5062);
+    position = nkData.getSamplePosition(0, 1e9);
+    EXPECT_EQ(position.sequence, 12);
+    EXPECT_EQ(position.sample, 0);
+
+    EXPECT_THROW(nkData.getSamplePosition(6, 0), std::runtime_error);
+    EXPECT_THROW(nkData.getSamplePosition(0, -1), std::runtime_error);
+}
+
+// Test that windows of samples are decoded straight from the waveform
+TEST(NihonKohdenDataTest, ReadSamples)
+{
+    NihonKohdenData nkData("test-file.MWF");
+    auto sameSamples = [](const double *left, const double *right, size_t count) // Missing samples are NaN
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            if (left[i] != right[i] && !(std::isnan(left[i]) && std::isnan(right[i])))
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    for (size_t i = 0; i < 6; i++)
+    {
+        std::vector<double> expected = nkData.getChannelData(i).toDoubles();
+        ASSERT_EQ(nkData.getSampleCount(i), expected.size());
+        uint64_t blockLength = nkData.getMetadata().channels[i].blockLength;
+        for (uint64_t first : {uint64_t(0), blockLength - 10, 3 * blockLength + 17})
+        {
+            std::vector<double> window(2 * blockLength + 20); // Spans three sequences
+            nkData.readSamples(i, first, window.size(), window.data());
+            EXPECT_TRUE(sameSamples(window.data(), expected.data() + first, window.size()));
+        }
+        std::vector<double> last(5);
+        nkData.readSamples(i, expected.size() - 5, 5, last.data());
+        EXPECT_TRUE(sameSamples(last.data(), expected.data() + expected.size() - 5, 5));
+    }
+
+    double sample = -1;
+    nkData.readSamples(0, 0, 0, &sample);
+    EXPECT_EQ(sample, -1);
+    EXPECT_THROW(nkData.readSamples(0, nkData.getSampleCount(0) - 4, 5, &sample), std::runtime_error);
+    EXPECT_THROW(nkData.readSamples(0, UINT64_MAX, 2, &sample), std::runtime_error);
+    EXPECT_THROW(nkData.readSamples(6, 0, 1, &sample), std::runtime_error);
+    EXPECT_THROW(nkData.getSampleCount(6), std::runtime_error);
+}
+
+// Test that a header with more sequences than the waveform holds is rejected, instead of samples being read past it
+TEST(NihonKohdenDataTest, TruncatedWaveform)
+{
+    ByteVector bv = FileManager::readBinaryFile("test-file.MWF");
+    const ByteVector seq = {0x06, 0x02, 0x0C, 0x00}; // SEQ tag of 12 sequences
+    auto position = std::search(bv.begin(), bv.end(), seq.begin(), seq.end());
+    ASSERT_NE(position, bv.end());
+    position[2] = 15;
+    FileManager::writeBinaryFile("output-truncated.mwf", bv);
+
+    EXPECT_THROW(NihonKohdenData("output-truncated.mwf"), std::runtime_error);
+    EXPECT_THROW(NihonKohdenData("output-truncated.mwf", true), std::runtime_error);
+    EXPECT_THROW(NihonKohdenData{ByteView(bv)}, std::runtime_error);
+}
+
+// Test that an interval is written from the overlapping sequences only
+TEST(NihonKohdenDataTest, WriteToCsvInterval)
+{
+    NihonKohdenData nkData("test-file.MWF");
+    nkData.setIntervalSelection(100.5, 130);
+    nkData.writeToCsv("output-interval.csv");
+
+    std::ifstream file("output-interval.csv");
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        lines.push_back(line);
+    }
+    ASSERT_EQ(lines.size(), 7376);
+    EXPECT_EQ(lines[1], "100.5, -54, -48, , , , 0");
+    EXPECT_EQ(lines.back(), "129.996, 27, 48, , , , 0");
+
+    // Exactly the second sequence, 60 s each
+    nkData.setIntervalSelection(60, 119.998);
+    nkData.writeToCsv("output-interval.csv");
+    file = std::ifstream("output-interval.csv");
+    lines.clear();
+    while (std::getline(file, line))
+    {
+        lines.push_back(line);
+    }
+    ASSERT_EQ(lines.size(), 15001);
+    EXPECT_EQ(lines[1].substr(0, 4), "60, ");
+    EXPECT_EQ(lines.back().substr(0, 9), "119.996, ");
+}
+
+// Test that an arrow file is written with one record batch per group of sequences
+TEST(NihonKohdenDataTest, WriteToArrow)
+{
+    NihonKohdenData nkData("test-file.MWF");
+    nkData.writeToArrow("output.arrow", 5);
+
+    ByteVector bytes = FileManager::readBinaryFile("output.arrow");
+    ASSERT_GT(bytes.size(), 12 * 135000);
+    EXPECT_EQ(std::string(bytes.begin(), bytes.begin() + 6), "ARROW1");
+    EXPECT_EQ(std::string(bytes.end() - 6, bytes.end()), "ARROW1");
+
+    EXPECT_THROW(nkData.writeToArrow("output.arrow", 0), std::runtime_error);
+}
+
+// Test that resampled rows align every channel on the target interval
+TEST(NihonKohdenDataTest, ReadResampled)
+{
+    NihonKohdenData nkData("test-file.MWF");
+    EXPECT_THROW(nkData.getResampledRowCount(), std::runtime_error);
+    nkData.setResampling(0.004, ResampleMode::LINEAR);
+    ASSERT_EQ(nkData.getResampledRowCount(), 180000);
+
+    std::vector<double> rows(7 * 100);
+    nkData.readResampled(14990, 100, rows.data()); // Across the end of the first sequence
+    std::vector<double> ecg = nkData.getChannelData(0).toDoubles();
+    std::vector<double> art = nkData.getChannelData(2).toDoubles();
+    for (size_t i = 0; i < 100; i++)
+    {
+        const double *row = rows.data() + i * 7;
+        uint64_t index = 14990 + i;
+        EXPECT_NEAR(row[0], index * 0.004, 1e-9);
+        EXPECT_EQ(row[1], ecg[index]); // Same rate
+        double expected = index % 2 == 0 ? art[index / 2] : (art[index / 2] + art[index / 2 + 1]) / 2; // Half the rate
+        EXPECT_DOUBLE_EQ(row[3], expected);
+    }
+    EXPECT_THROW(nkData.readResampled(179990, 11, rows.data()), std::runtime_error);
+
+    nkData.setChannelSelection(0, false);
+    nkData.setIntervalSelection(100, 101);
+    EXPECT_EQ(nkData.getResampledRowCount(), 251);
+    nkData.readResampled(0, 1, rows.data());
+    EXPECT_NEAR(rows[0], 100, 1e-9);
+    EXPECT_EQ(rows[1], nkData.getChannelData(1).toDoubles()[25000]);
+
+    nkData.setResampling(0);
+    EXPECT_THROW(nkData.getResampledRowCount(), std::runtime_error);
+    EXPECT_THROW(nkData.setResampling(-1), std::runtime_error);
+}
+
+// Test that the resampled csv has a value in every cell, with any number of threads
+TEST(NihonKohdenDataTest, WriteToCsvResampled)
+{
+    NihonKohdenData nkData("test-file.MWF");
+    nkData.setVerbose(false);
+    nkData.setResampling(0.008, ResampleMode::POLYPHASE);
+    nkData.writeToCsv("output-resampled.csv");
+    nkData.writeToCsv("output-resampled-threads.csv", CsvWriter::defaultPrecision, 4);
+
+    std::ifstream file("output-resampled.csv");
+    std::string line;
+    std::getline(file, line);
+    EXPECT_EQ(line, "Time: (s), ECG II: 2x10^-6 (V), ECG V5: 2x10^-6 (V), ART: 125x10^-3 (mmHg), PAP: 125x10^-3 (mmHg), CVP: 125x10^-3 (mmHg), Pacing Status: N/A");
+    size_t lineCount = 0;
+    while (std::getline(file, line))
+    {
+        EXPECT_EQ(line.find(", ,"), std::string::npos);
+        EXPECT_NE(line.back(), ' ');
+        lineCount++;
+    }
+    EXPECT_EQ(lineCount, 90000);
+    EXPECT_EQ(FileManager::readBinaryFile("output-resampled.csv"), FileManager::readBinaryFile("output-resampled-threads.csv"));
+}
+
+// Test that resampled channels are written to arrow as float64
+TEST(NihonKohdenDataTest, WriteToArrowResampled)
+{
+    NihonKohdenData nkData("test-file.MWF");
+    nkData.setVerbose(false);
+    nkData.setResampling(0.002, ResampleMode::HOLD);
+    nkData.writeToArrow("output-resampled.arrow", 5);
+
+    ByteVector bytes = FileManager::readBinaryFile("output-resampled.arrow");
+    ASSERT_GT(bytes.size(), 360000 * 7 * 8);
+    EXPECT_EQ(std::string(bytes.begin(), bytes.begin() + 6), "ARROW1");
+    EXPECT_EQ(std::string(bytes.end() - 6, bytes.end()), "ARROW1");
+}
+
 int main(int argc, char **argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include "Resampler.h"
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace
+{
+    constexpr double pi = 3.14159265358979323846;
+
+    std::vector<double> resampleAll(const Resampler &resampler, const std::vector<double> &source, uint64_t firstOutput, uint64_t count)
+    {
+        std::pair<uint64_t, uint64_t> range = resampler.getSourceRange(firstOutput, count);
+        std::vector<double> output(count);
+        resampler.resample(source.data() + range.first, firstOutput, count, output.data());
+        return output;
+    }
+
+    std::vector<double> sine(double frequency, double interval, size_t count)
+    {
+        std::vector<double> samples(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            samples[i] = std::sin(2 * pi * frequency * i * interval);
+        }
+        return samples;
+    }
+
+    double peak(const std::vector<double> &samples, size_t first, size_t last)
+    {
+        double peak = 0;
+        for (size_t i = first; i < last; i++)
+        {
+            peak = std::max(peak, std::abs(samples[i]));
+        }
+        return peak;
+    }
+}
+
+// Test the names of the modes
+TEST(ResamplerTest, ModeNames)
+{
+    for (ResampleMode mode : {ResampleMode::HOLD, ResampleMode::LINEAR, ResampleMode::POLYPHASE})
+    {
+        EXPECT_EQ(getResampleMode(getResampleModeName(mode)), mode);
+    }
+    EXPECT_EQ(getResampleModeName(ResampleMode::POLYPHASE), "polyphase");
+    EXPECT_THROW(getResampleMode("cubic"), std::runtime_error);
+    EXPECT_THROW(Resampler(0.004, 0, ResampleMode::LINEAR, 10), std::runtime_error);
+    EXPECT_THROW(Resampler(1e-7, 0.004, ResampleMode::LINEAR, 10), std::runtime_error);
+}
+
+// Test upsampling a channel by two
+TEST(ResamplerTest, HoldAndLinear)
+{
+    std::vector<double> source = {0, 2, 4, 8};
+    Resampler hold(0.008, 0.004, ResampleMode::HOLD, source.size());
+    Resampler linear(0.008, 0.004, ResampleMode::LINEAR, source.size());
+
+    ASSERT_EQ(hold.getOutputCount(), 8);
+    EXPECT_EQ(resampleAll(hold, source, 0, 8), (std::vector<double>{0, 0, 2, 2, 4, 4, 8, 8}));
+    EXPECT_EQ(resampleAll(linear, source, 0, 8), (std::vector<double>{0, 1, 2, 3, 4, 6, 8, 8})); // The last sample is held
+    EXPECT_EQ(resampleAll(linear, source, 3, 2), (std::vector<double>{3, 4}));
+
+    // Downsampling by 1.5 picks the samples and midpoints at 0, 1.5 and 3
+    Resampler downsample(0.004, 0.006, ResampleMode::LINEAR, source.size());
+    EXPECT_EQ(downsample.getOutputCount(), 3);
+    EXPECT_EQ(resampleAll(downsample, source, 0, 3), (std::vector<double>{0, 3, 8}));
+}
+
+// Test that a missing sample makes the outputs it contributes to missing
+TEST(ResamplerTest, MissingSamples)
+{
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<double> source = {0, nan, 4, 8};
+    std::vector<double> output = resampleAll(Resampler(0.008, 0.004, ResampleMode::LINEAR, source.size()), source, 0, 8);
+    EXPECT_EQ(output[0], 0);
+    EXPECT_TRUE(std::isnan(output[1]) && std::isnan(output[2]) && std::isnan(output[3]));
+    EXPECT_EQ(output[4], 4);
+
+    output = resampleAll(Resampler(0.004, 0.004, ResampleMode::LINEAR, 0), {}, 0, 2);
+    EXPECT_TRUE(std::isnan(output[0]) && std::isnan(output[1]));
+}
+
+// Test that the same interval gives back the source in every mode
+TEST(ResamplerTest, SameInterval)
+{
+    std::vector<double> source = sine(3, 0.004, 1000);
+    for (ResampleMode mode : {ResampleMode::HOLD, ResampleMode::LINEAR, ResampleMode::POLYPHASE})
+    {
+        std::vector<double> output = resampleAll(Resampler(0.004, 0.004, mode, source.size()), source, 0, source.size());
+        for (size_t i = 0; i < source.size(); i++)
+        {
+            EXPECT_NEAR(output[i], source[i], 1e-12);
+        }
+    }
+}
+
+// Test that the polyphase filter interpolates band-limited signals and removes tones above the target Nyquist rate
+TEST(ResamplerTest, Polyphase)
+{
+    // 5 Hz at 125 Hz to 500 Hz
+    Resampler up(0.008, 0.002, ResampleMode::POLYPHASE, 2000);
+    EXPECT_EQ(up.getPhaseCount(), 4);
+    std::vector<double> output = resampleAll(up, sine(5, 0.008, 2000), 0, up.getOutputCount());
+    std::vector<double> expected = sine(5, 0.002, output.size());
+    for (size_t i = 100; i < output.size() - 100; i++) // Away from the held ends
+    {
+        EXPECT_NEAR(output[i], expected[i], 1e-3);
+    }
+
+    // 1000 Hz to 100 Hz keeps 5 Hz and removes 200 Hz instead of aliasing it
+    Resampler down(0.001, 0.01, ResampleMode::POLYPHASE, 20000);
+    EXPECT_EQ(down.getTapCount(), 160);
+    std::vector<double> low = resampleAll(down, sine(5, 0.001, 20000), 0, down.getOutputCount());
+    std::vector<double> high = resampleAll(down, sine(200, 0.001, 20000), 0, down.getOutputCount());
+    EXPECT_NEAR(peak(low, 20, 1980), 1, 0.01);
+    EXPECT_LT(peak(high, 20, 1980), 0.01);
+    EXPECT_NEAR(peak(resampleAll(Resampler(0.001, 0.01, ResampleMode::HOLD, 20000), sine(210, 0.001, 20000), 0, 2000), 20, 1980), 1, 0.1); // Aliased
+
+    // Intervals without a small ratio round the phase to the bank
+    Resampler irregular(0.004, 0.0039993, ResampleMode::POLYPHASE, 1000);
+    EXPECT_EQ(irregular.getPhaseCount(), Resampler::maxPhases);
+}
+
+// Test that outputs resampled in parts match outputs resampled at once, as the outputs are streamed
+TEST(ResamplerTest, Parts)
+{
+    std::vector<double> source = sine(7, 0.004, 5000);
+    for (ResampleMode mode : {ResampleMode::HOLD, ResampleMode::LINEAR, ResampleMode::POLYPHASE})
+    {
+        for (double target : {0.001, 0.003, 0.01, 0.0041})
+        {
+            Resampler resampler(0.004, target, mode, source.size());
+            std::vector<double> whole = resampleAll(resampler, source, 0, resampler.getOutputCount());
+            for (uint64_t first = 0; first < whole.size(); first += 997)
+            {
+                uint64_t count = std::min<uint64_t>(997, whole.size() - first);
+                std::vector<double> part = resampleAll(resampler, source, first, count);
+                ASSERT_TRUE(std::equal(part.begin(), part.end(), whole.begin() + first));
+            }
+        }
+    }
+}
+
+// Test that positions are exact fractions, so outputs do not drift over long recordings
+TEST(ResamplerTest, NoDrift)
+{
+    Resampler resampler(0.004, 0.001, ResampleMode::HOLD, uint64_t(1) << 32);
+    EXPECT_EQ(resampler.getOutputCount(), uint64_t(1) << 34);
+    std::pair<uint64_t, uint64_t> range = resampler.getSourceRange((uint64_t(1) << 34) - 4, 4);
+    EXPECT_EQ(range.first, (uint64_t(1) << 32) - 1);
+    EXPECT_EQ(range.second, uint64_t(1) << 32);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
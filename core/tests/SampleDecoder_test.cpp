@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include "SampleDecoder.h"
+#include <cmath>
+#include <vector>
+
+const std::vector<DataType> dataTypes = {
+    DataType::INT_16_S, DataType::INT_16_U, DataType::INT_32_S, DataType::INT_8_U, DataType::STATUS_16,
+    DataType::INT_8_S, DataType::INT_32_U, DataType::FLOAT_32, DataType::FLOAT_64, DataType::AHA_8};
+
+const std::vector<DecodeKernel> kernels = {DecodeKernel::SCALAR, DecodeKernel::SSE2, DecodeKernel::AVX2};
+
+// Helper function to create a deterministic pseudo-random byte pattern
+ByteVector patternBytes(size_t size)
+{
+    ByteVector bytes(size);
+    uint32_t state = 12345;
+    for (auto &byte : bytes)
+    {
+        state = state * 1103515245 + 12345;
+        byte = static_cast<uint8_t>(state >> 16);
+    }
+    return bytes;
+}
+
+bool sameValue(double a, double b)
+{
+    return a == b || (std::isnan(a) && std::isnan(b));
+}
+
+// Test that every supported kernel matches per-sample decoding, including the scalar tails
+TEST(SampleDecoderTest, KernelsMatchReference)
+{
+    const size_t count = 67;
+    for (DataType dataType : dataTypes)
+    {
+        size_t size = getDataTypeSize(dataType);
+        ByteVector bytes = patternBytes(count * size);
+        for (ByteOrder byteOrder : {ByteOrder::ENDIAN_BIG, ByteOrder::ENDIAN_LITTLE})
+        {
+            std::vector<double> expected(count);
+            for (size_t i = 0; i < count; i++)
+            {
+                ByteView sample = ByteView(bytes).subview(i * size, size);
+                switch (dataType)
+                {
+                case DataType::INT_16_S:
+                {
+                    int16_t value = sample.toInt<int16_t>(byteOrder);
+                    expected[i] = value == -32768 ? NAN : value;
+                    break;
+                }
+                case DataType::INT_16_U:
+                case DataType::STATUS_16:
+                    expected[i] = sample.toInt<uint16_t>(byteOrder);
+                    break;
+                case DataType::INT_32_S:
+                    expected[i] = sample.toInt<int32_t>(byteOrder);
+                    break;
+                case DataType::INT_32_U:
+                    expected[i] = sample.toInt<uint32_t>(byteOrder);
+                    break;
+                case DataType::INT_8_S:
+                    expected[i] = sample.toInt<int8_t>(byteOrder);
+                    break;
+                case DataType::FLOAT_32:
+                    expected[i] = sample.toInt<float>(byteOrder);
+                    break;
+                case DataType::FLOAT_64:
+                    expected[i] = sample.toInt<double>(byteOrder);
+                    break;
+                default:
+                    expected[i] = sample.toInt<uint8_t>(byteOrder);
+                    break;
+                }
+            }
+
+            for (DecodeKernel kernel : kernels)
+            {
+                if (!isDecodeKernelSupported(kernel))
+                {
+                    continue;
+                }
+                std::vector<double> output(count);
+                decodeSamples(bytes.data(), count, dataType, byteOrder, output.data(), kernel);
+                for (size_t i = 0; i < count; i++)
+                {
+                    EXPECT_TRUE(sameValue(output[i], expected[i]))
+                        << decodeKernelName(kernel) << " type " << (int)dataType << " sample " << i << ": " << output[i] << " != " << expected[i];
+                }
+            }
+        }
+    }
+}
+
+// Test that the INT_16_S missing data sentinel decodes to NaN
+TEST(SampleDecoderTest, MissingSampleIsNaN)
+{
+    ByteVector bytes;
+    for (int i = 0; i < 20; i++)
+    {
+        bytes.push_back(i % 3 == 0 ? 0x00 : 0x01);
+        bytes.push_back(i % 3 == 0 ? 0x80 : 0x00);
+    }
+    for (DecodeKernel kernel : kernels)
+    {
+        if (!isDecodeKernelSupported(kernel))
+        {
+            continue;
+        }
+        std::vector<double> output(20);
+        decodeSamples(bytes.data(), 20, DataType::INT_16_S, ByteOrder::ENDIAN_LITTLE, output.data(), kernel);
+        for (int i = 0; i < 20; i++)
+        {
+            if (i % 3 == 0)
+            {
+                EXPECT_TRUE(std::isnan(output[i]));
+            }
+            else
+            {
+                EXPECT_EQ(output[i], 1.0);
+            }
+        }
+    }
+}
+
+// Test for an invalid data type
+TEST(SampleDecoderTest, InvalidDataType)
+{
+    ByteVector bytes(8);
+    std::vector<double> output(8);
+    EXPECT_THROW(decodeSamples(bytes.data(), 8, static_cast<DataType>(0x20), ByteOrder::ENDIAN_LITTLE, output.data()), std::runtime_error);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,209 @@
+#include <gtest/gtest.h>
+#include "SummaryPyramid.h"
+#include "MFERGenerator.h"
+#include "Anonymizer.h"
+#include "FileManager.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+    // Summary of samples first to first + length computed directly from the channel
+    SummaryBin summarize(const std::vector<double> &samples, uint64_t first, uint64_t length)
+    {
+        float min = std::numeric_limits<float>::infinity();
+        float max = -std::numeric_limits<float>::infinity();
+        double sum = 0;
+        uint32_t count = 0;
+        for (uint64_t i = first; i < std::min<uint64_t>(first + length, samples.size()); i++)
+        {
+            if (!std::isnan(samples[i]))
+            {
+                min = std::min(min, static_cast<float>(samples[i]));
+                max = std::max(max, static_cast<float>(samples[i]));
+                sum += samples[i];
+                count++;
+            }
+        }
+        return {min, max, static_cast<float>(sum / count), count};
+    }
+
+    void expectBin(const SummaryBin &bin, const SummaryBin &expected)
+    {
+        EXPECT_EQ(bin.count, expected.count);
+        if (expected.count == 0)
+        {
+            EXPECT_TRUE(std::isnan(bin.min) && std::isnan(bin.max) && std::isnan(bin.mean));
+            return;
+        }
+        EXPECT_EQ(bin.min, expected.min);
+        EXPECT_EQ(bin.max, expected.max);
+        EXPECT_NEAR(bin.mean, expected.mean, 1e-3 * (std::abs(expected.mean) + 1));
+    }
+}
+
+// Test that every level summarizes the samples it covers
+TEST(SummaryPyramidTest, Levels)
+{
+    NihonKohdenData data("test-file.MWF");
+    SummaryPyramid pyramid(data);
+
+    ASSERT_EQ(pyramid.getChannelCount(), 6);
+    EXPECT_EQ(pyramid.getBinLength(0), 1);
+    EXPECT_EQ(pyramid.getBinLength(1), 16);
+    EXPECT_EQ(pyramid.getBinLength(3), 256);
+    for (size_t channel = 0; channel < 6; channel++)
+    {
+        std::vector<double> samples = data.getChannelData(channel).toDoubles();
+        size_t levelCount = pyramid.getLevelCount(channel);
+        ASSERT_GT(levelCount, 0);
+        EXPECT_GE(pyramid.getBinLength(levelCount), samples.size());
+        EXPECT_LT(pyramid.getBinLength(levelCount - 1), samples.size());
+        ASSERT_EQ(pyramid.getLevel(channel, levelCount).size(), 1);
+
+        for (size_t level = 1; level <= levelCount; level++)
+        {
+            const std::vector<SummaryBin> &bins = pyramid.getLevel(channel, level);
+            uint64_t binLength = pyramid.getBinLength(level);
+            ASSERT_EQ(bins.size(), (samples.size() + binLength - 1) / binLength);
+            for (size_t i : {size_t(0), bins.size() / 2, bins.size() - 1})
+            {
+                expectBin(bins[i], summarize(samples, i * binLength, binLength));
+            }
+        }
+    }
+    EXPECT_THROW(pyramid.getLevel(0, 0), std::runtime_error);
+    EXPECT_THROW(pyramid.getLevel(6, 1), std::runtime_error);
+}
+
+// Test that missing samples are left out of the bins
+TEST(SummaryPyramidTest, MissingSamples)
+{
+    GeneratorOptions options;
+    options.channels = {{Lead::ECG_II, DataType::INT_16_S, 1000, 4, -6, 2}, {Lead::ART, DataType::FLOAT_32, 500, 8, -3, 125}};
+    options.sequenceCount = 3;
+    options.missingDensity = 0.3;
+    ByteVector bytes = generateMFER(options);
+    NihonKohdenData data{ByteView(bytes)};
+    SummaryPyramid pyramid(data, {10, 3});
+
+    for (size_t channel = 0; channel < 2; channel++)
+    {
+        std::vector<double> samples = data.getChannelData(channel).toDoubles();
+        for (size_t level = 1; level <= pyramid.getLevelCount(channel); level++)
+        {
+            const std::vector<SummaryBin> &bins = pyramid.getLevel(channel, level);
+            for (size_t i = 0; i < bins.size(); i++)
+            {
+                expectBin(bins[i], summarize(samples, i * pyramid.getBinLength(level), pyramid.getBinLength(level)));
+            }
+        }
+        EXPECT_LT(pyramid.getLevel(channel, pyramid.getLevelCount(channel))[0].count, samples.size());
+    }
+    EXPECT_THROW(SummaryPyramid(data, {0, 4}), std::runtime_error);
+    EXPECT_THROW(SummaryPyramid(data, {16, 1}), std::runtime_error);
+}
+
+// Test that a query returns the level matching the pixels
+TEST(SummaryPyramidTest, Query)
+{
+    NihonKohdenData data("test-file.MWF");
+    SummaryPyramid pyramid(data);
+
+    // 720 seconds of channel 0, 180000 samples over 1000 pixels
+    SummaryRange range = pyramid.query(0, 0, 720, 1000);
+    EXPECT_EQ(range.level, 2);
+    EXPECT_EQ(range.binLength, 64);
+    EXPECT_EQ(range.firstBin, 0);
+    EXPECT_DOUBLE_EQ(range.binDuration, 64 * 0.004);
+    EXPECT_GE(range.bins.size(), 1000);
+    EXPECT_LE(range.bins.size(), 4000);
+
+    range = pyramid.query(0, 100, 160, 50);
+    EXPECT_EQ(range.level, 3);
+    EXPECT_EQ(range.firstBin, 25000 / 256);
+    EXPECT_LE(range.start, 100);
+    EXPECT_GT(range.start + range.binDuration, 100);
+    EXPECT_GE(range.start + range.binDuration * range.bins.size(), 160);
+    expectBin(range.bins[0], pyramid.getLevel(0, 3)[range.firstBin]);
+
+    // Raw samples for ranges shorter than a bin per pixel, only when the data is given
+    range = pyramid.query(0, 100, 101, 1000, &data);
+    EXPECT_EQ(range.level, 0);
+    EXPECT_EQ(range.firstBin, 25000);
+    ASSERT_EQ(range.bins.size(), 250);
+    EXPECT_EQ(range.bins[3].min, static_cast<float>(data.getChannelData(0).value(25003)));
+    EXPECT_EQ(pyramid.query(0, 100, 101, 1000).level, 1);
+
+    EXPECT_TRUE(pyramid.query(0, 1000, 2000, 100).bins.empty()); // After the end of the recording
+    range = pyramid.query(2, 0, 1e9, 1); // 90000 samples, the last level is a single bin of 262144
+    EXPECT_EQ(range.level, pyramid.getLevelCount(2) - 1);
+    EXPECT_EQ(range.bins.size(), 2);
+    EXPECT_THROW(pyramid.query(0, 10, 5, 100), std::runtime_error);
+    EXPECT_THROW(pyramid.query(0, 0, 5, 0), std::runtime_error);
+    EXPECT_THROW(pyramid.query(6, 0, 5, 100), std::runtime_error);
+}
+
+// Test that a pyramid is read back as written, and corrupt files are rejected
+TEST(SummaryPyramidTest, Serialize)
+{
+    NihonKohdenData data("test-file.MWF");
+    SummaryPyramid pyramid(data);
+    pyramid.write("test-file.MWF.sum");
+    SummaryPyramid read = SummaryPyramid::read("test-file.MWF.sum", data);
+
+    ASSERT_EQ(read.getChannelCount(), pyramid.getChannelCount());
+    for (size_t channel = 0; channel < pyramid.getChannelCount(); channel++)
+    {
+        ASSERT_EQ(read.getLevelCount(channel), pyramid.getLevelCount(channel));
+        for (size_t level = 1; level <= pyramid.getLevelCount(channel); level++)
+        {
+            const std::vector<SummaryBin> &bins = pyramid.getLevel(channel, level);
+            const std::vector<SummaryBin> &readBins = read.getLevel(channel, level);
+            ASSERT_EQ(readBins.size(), bins.size());
+            EXPECT_EQ(std::memcmp(readBins.data(), bins.data(), bins.size() * sizeof(SummaryBin)), 0); // NaN bins included
+        }
+    }
+    EXPECT_EQ(read.query(0, 0, 720, 1000).bins.size(), pyramid.query(0, 0, 720, 1000).bins.size());
+
+    ByteVector bytes = pyramid.serialize();
+    EXPECT_THROW(SummaryPyramid::parse(ByteView(bytes.data(), bytes.size() - 1)), std::runtime_error);
+    bytes[20] ^= 0x01;
+    EXPECT_THROW(SummaryPyramid::parse(bytes), std::runtime_error);
+    EXPECT_THROW(SummaryPyramid::parse(ByteVector(64, 0x00)), std::runtime_error);
+}
+
+// Test that a pyramid is only used with the recording it summarizes, as it was summarized
+TEST(SummaryPyramidTest, StaleRecording)
+{
+    FileManager::writeBinaryFile("output-summary.mwf", FileManager::readBinaryFile("test-file.MWF"));
+    {
+        NihonKohdenData data("output-summary.mwf");
+        SummaryPyramid pyramid(data);
+        EXPECT_TRUE(pyramid.matches(data));
+        pyramid.write("output-summary.mwf.sum");
+    }
+
+    anonymizeFile("output-summary.mwf"); // Replaces the recording with the same samples and sample counts
+    NihonKohdenData replaced("output-summary.mwf");
+    EXPECT_THROW(SummaryPyramid::read("output-summary.mwf.sum", replaced), std::runtime_error);
+    SummaryPyramid pyramid = SummaryPyramid::parse(FileManager::readBinaryFile("output-summary.mwf.sum"));
+    EXPECT_FALSE(pyramid.matches(replaced));
+    EXPECT_NO_THROW(pyramid.query(0, 0, 720, 1000));
+    EXPECT_THROW(pyramid.query(0, 0, 720, 1000, &replaced), std::runtime_error);
+    EXPECT_THROW(pyramid.query(0, 100, 101, 1000, &replaced), std::runtime_error);
+
+    // Data in memory has no file to match
+    ByteVector bytes = FileManager::readBinaryFile("test-file.MWF");
+    NihonKohdenData inMemory{ByteView(bytes)};
+    EXPECT_TRUE(SummaryPyramid(inMemory).matches(inMemory));
+    EXPECT_FALSE(SummaryPyramid(inMemory).matches(replaced));
+    EXPECT_FALSE(pyramid.matches(inMemory));
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,156 @@
+#include "MFERGenerator.h"
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+// Generates synthetic MFER recordings for scale and stress testing
+static void printUsage()
+{
+    std::cout << "Usage: monk_generate <output> [options]\n"
+              << "  --sequences N          Number of sequences (default 12)\n"
+              << "  --channel SPEC         Add a channel, replacing the default channels of the test file.\n"
+              << "                         SPEC is LEAD:TYPE:BLOCK:INTERVAL[:EXPONENT:BASE], where LEAD is a lead code\n"
+              << "                         or name such as \"ECG II\", TYPE a data type such as int16s or float32,\n"
+              << "                         BLOCK the samples per sequence, INTERVAL the milliseconds per sample\n"
+              << "                         and BASE x10^EXPONENT the resolution, BASE 0 leaving it out\n"
+              << "  --interval MS          Sampling interval of the header in milliseconds (default 1)\n"
+              << "  --byte-order ORDER     little (default) or big\n"
+              << "  --events N             Number of NIBP events (default 0)\n"
+              << "  --missing FRACTION     Fraction of missing samples (default 0)\n"
+              << "  --seed N               Seed of the samples (default 0)\n"
+              << "  --count N              Write N recordings with seeds N, N + 1, ... into the output directory\n";
+}
+
+static Lead parseLead(const std::string &text)
+{
+    for (const auto &entry : LeadMap)
+    {
+        if (entry.second.attribute == text)
+        {
+            return entry.first;
+        }
+    }
+    return static_cast<Lead>(std::stoul(text, nullptr, 0));
+}
+
+static GeneratorChannel parseChannel(const std::string &spec)
+{
+    std::vector<std::string> parts;
+    std::stringstream stream(spec);
+    std::string part;
+    while (std::getline(stream, part, ':'))
+    {
+        parts.push_back(part);
+    }
+    if (parts.size() != 4 && parts.size() != 6)
+    {
+        throw std::runtime_error("Invalid channel: " + spec);
+    }
+    GeneratorChannel channel;
+    channel.lead = parseLead(parts[0]);
+    channel.dataType = getDataTypeFromName(parts[1]);
+    channel.blockLength = static_cast<uint32_t>(std::stoul(parts[2]));
+    channel.samplingInterval = static_cast<uint8_t>(std::stoul(parts[3]));
+    if (parts.size() == 6)
+    {
+        channel.resolutionExponent = static_cast<int8_t>(std::stoi(parts[4]));
+        channel.resolutionBase = static_cast<uint16_t>(std::stoul(parts[5]));
+    }
+    return channel;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || std::string(argv[1]) == "--help")
+    {
+        printUsage();
+        return argc < 2 ? 1 : 0;
+    }
+
+    try
+    {
+        std::string output = argv[1];
+        GeneratorOptions options;
+        std::vector<GeneratorChannel> channels;
+        uint64_t count = 0;
+        for (int i = 2; i < argc; i++)
+        {
+            std::string option = argv[i];
+            if (i + 1 >= argc)
+            {
+                throw std::runtime_error("Missing value for " + option);
+            }
+            std::string value = argv[++i];
+            if (option == "--sequences")
+            {
+                options.sequenceCount = static_cast<uint16_t>(std::stoul(value));
+            }
+            else if (option == "--channel")
+            {
+                channels.push_back(parseChannel(value));
+            }
+            else if (option == "--interval")
+            {
+                options.samplingInterval = static_cast<uint8_t>(std::stoul(value));
+            }
+            else if (option == "--byte-order")
+            {
+                if (value != "little" && value != "big")
+                {
+                    throw std::runtime_error("Byte order must be little or big");
+                }
+                options.byteOrder = value == "big" ? ByteOrder::ENDIAN_BIG : ByteOrder::ENDIAN_LITTLE;
+            }
+            else if (option == "--events")
+            {
+                options.eventCount = static_cast<uint32_t>(std::stoul(value));
+            }
+            else if (option == "--missing")
+            {
+                options.missingDensity = std::stod(value);
+            }
+            else if (option == "--seed")
+            {
+                options.seed = std::stoull(value);
+            }
+            else if (option == "--count")
+            {
+                count = std::stoull(value);
+            }
+            else
+            {
+                throw std::runtime_error("Unknown option: " + option);
+            }
+        }
+        if (!channels.empty())
+        {
+            options.channels = channels;
+        }
+
+        if (count == 0)
+        {
+            generateMFERFile(output, options);
+            std::cout << "Generated " << output << std::endl;
+            return 0;
+        }
+
+        std::filesystem::create_directories(output);
+        uint64_t seed = options.seed;
+        for (uint64_t i = 0; i < count; i++)
+        {
+            std::ostringstream name;
+            name << "synthetic-" << std::setw(6) << std::setfill('0') << i << ".MWF";
+            options.seed = seed + i;
+            generateMFERFile((std::filesystem::path(output) / name.str()).string(), options);
+            std::cout << "\r" << (i + 1) << " / " << count << " recordings generated";
+        }
+        std::cout << std::endl;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -1,5 +1,5 @@
 # Anonymize and write the data from a MFER file to a new file
-from monklib import Data
+from monklib import anonymize_file
 import argparse
 
 # Initialize the parser
@@ -11,6 +11,5 @@ parser.add_argument('output', help='Output binary data file path')
 # Parse the command line arguments
 args = parser.parse_args()
 
-data = Data(args.input)
-data.anonymize()
-data.writeToBinary(args.output)
\ No newline at end of file
+# Copy the file and overwrite only the identifying fields of the copy
+anonymize_file(args.input, args.output)
\ No newline at end of file
@@ -140,4 +140,5 @@ setup(
     cmdclass=dict(build_ext=CMakeBuild),
     zip_safe=False,
     python_requires=">=3.8",
+    install_requires=["numpy"],
 )